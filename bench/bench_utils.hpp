@@ -0,0 +1,57 @@
+#ifndef BENCH_UTILS_HPP
+#define BENCH_UTILS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+class BenchTimer {
+ public:
+  BenchTimer() : start_{std::chrono::steady_clock::now()} {
+  }
+
+  [[nodiscard]] double ElapsedNs() const {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+
+};
+
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template<typename FuncT>
+double MeasureNs(const size_t repeats, FuncT&& func) {
+  double best = 0;
+  for (size_t i = 0; i < repeats; ++i) {
+    BenchTimer timer;
+    func();
+    double elapsed = timer.ElapsedNs();
+    if (i == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+// Like MeasureNs, but only func(state) is timed; setup() builds a fresh state for each repeat.
+template<typename SetupT, typename FuncT>
+double MeasureNs(const size_t repeats, SetupT&& setup, FuncT&& func) {
+  double best = 0;
+  for (size_t i = 0; i < repeats; ++i) {
+    auto state = setup();
+    BenchTimer timer;
+    func(state);
+    double elapsed = timer.ElapsedNs();
+    if (i == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+#endif /* bench_utils.hpp */
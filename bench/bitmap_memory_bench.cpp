@@ -0,0 +1,69 @@
+#include "compressed_bit_storage.hpp"
+#include "bench_utils.hpp"
+
+#include <random>
+
+using DenseBits      = Vector<bool>;
+using CompressedBits = Vector<bool, CompressedBitStorage>;
+
+// Sets about density * size random bits, plus one run of run_len bits when run_len != 0.
+void FillMask(DenseBits& dense, CompressedBits& compressed, const double density, const size_t run_len,
+              std::mt19937_64& gen) {
+  std::uniform_int_distribution<size_t> dist(0, dense.Size() - 1);
+  const size_t set_cnt = static_cast<size_t>(density * dense.Size());
+  for (size_t i = 0; i < set_cnt; ++i) {
+    const size_t index = dist(gen);
+    dense[index] = true;
+    compressed[index] = true;
+  }
+
+  if (run_len != 0) {
+    const size_t first = dense.Size() / 3;
+    dense.SetRange(first, first + run_len);
+    compressed.SetRange(first, first + run_len);
+  }
+  compressed.Shrink();
+}
+
+void BenchDensity(const size_t size, const double density, const size_t run_len) {
+  std::mt19937_64 gen(size);
+  DenseBits dense(size);
+  DenseBits other_dense(size);
+  CompressedBits compressed(size);
+  CompressedBits other_compressed(size);
+  FillMask(dense, compressed, density, run_len, gen);
+  FillMask(other_dense, other_compressed, density, run_len, gen);
+
+  const size_t dense_bytes = sizeof(DenseBits) + dense.WordsCnt() * sizeof(uint64_t);
+  const size_t compressed_bytes = compressed.BytesUsed();
+
+  const double dense_and = MeasureNs(5, [&] {
+    DenseBits result = dense & other_dense;
+    DoNotOptimize(result.WordsCnt());
+  });
+  const double compressed_and = MeasureNs(5, [&] {
+    CompressedBits result = compressed & other_compressed;
+    DoNotOptimize(result.ContainersCnt());
+  });
+  const double mixed_and = MeasureNs(5, [&] {
+    CompressedBits result = compressed & other_dense;
+    DoNotOptimize(result.ContainersCnt());
+  });
+
+  printf("density %8.4f%% run %9zu: dense %10zu B, compressed %10zu B (%6.2f%%), "
+         "and dense %9.1f us, compressed %9.1f us, mixed %9.1f us\n",
+         density * 100, run_len, dense_bytes, compressed_bytes, 100.0 * compressed_bytes / dense_bytes,
+         dense_and / 1e3, compressed_and / 1e3, mixed_and / 1e3);
+}
+
+int main(int argc, char* argv[]) {
+  const size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : (1 << 26);
+
+  const double densities[] = {0.0001, 0.001, 0.01, 0.1, 0.5};
+  for (double density : densities) {
+    BenchDensity(size, density, 0);
+  }
+  BenchDensity(size, 0.0001, size / 4);
+
+  return 0;
+}
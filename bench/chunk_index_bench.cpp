@@ -0,0 +1,65 @@
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+#include <random>
+
+struct Triple {
+  int a_ = 0;
+  int b_ = 0;
+  int c_ = 0;
+};
+
+template<typename ElemT>
+int Value(const ElemT& elem) {
+  if constexpr (std::is_same_v<ElemT, Triple>) {
+    return elem.a_;
+  } else {
+    return elem;
+  }
+}
+
+template<typename ElemT, template<typename StorageT, size_t StorageSize> class Storage>
+void BenchRandomAccess(const char* name, const size_t size, const std::vector<size_t>& indices) {
+  Vector<ElemT, Storage> vector(size);
+  for (size_t i = 0; i < size; ++i) {
+    vector.At(i) = ElemT{static_cast<int>(i)};
+  }
+
+  double elapsed = MeasureNs(5, [&] {
+    long long sum = 0;
+    for (size_t index : indices) {
+      sum += Value(vector.At(index));
+    }
+    DoNotOptimize(sum);
+  });
+
+  printf("%-26s %10zu elems: %8.2f ns/access, %8.1f M accesses/s\n",
+         name, size, elapsed / indices.size(), indices.size() / elapsed * 1e3);
+}
+
+template<typename ElemT>
+void BenchElemType(const char* elem_name, const size_t size, const size_t accesses_cnt) {
+  std::mt19937_64 gen(size);
+  std::uniform_int_distribution<size_t> dist(0, size - 1);
+  std::vector<size_t> indices(accesses_cnt);
+  for (size_t& index : indices) {
+    index = dist(gen);
+  }
+
+  printf("%s (%zu bytes), byte-sized chunk holds %zu elements\n", elem_name, sizeof(ElemT),
+         ChunkedStorage<ElemT>::FULL_CHUNK_SIZE_);
+  BenchRandomAccess<ElemT, DynamicStorage>("DynamicStorage", size, indices);
+  BenchRandomAccess<ElemT, ChunkedStorage>("ChunkedStorage", size, indices);
+  BenchRandomAccess<ElemT, PowerOfTwoChunkedStorage>("PowerOfTwoChunkedStorage", size, indices);
+  BenchRandomAccess<ElemT, PageChunkedStorage>("PageChunkedStorage", size, indices);
+}
+
+int main(int argc, char* argv[]) {
+  const size_t size          = argc > 1 ? strtoull(argv[1], nullptr, 10) : (1 << 20);
+  const size_t accesses_cnt  = argc > 2 ? strtoull(argv[2], nullptr, 10) : (1 << 24);
+
+  BenchElemType<int>("int", size, accesses_cnt);
+  BenchElemType<Triple>("Triple", size, accesses_cnt);
+
+  return 0;
+}
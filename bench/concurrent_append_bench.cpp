@@ -0,0 +1,52 @@
+#include "concurrent_chunked_vector.hpp"
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+template<typename AppendT>
+double MeasureAppends(const size_t threads_cnt, const size_t per_thread, AppendT&& append) {
+  BenchTimer timer;
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < threads_cnt; ++thread) {
+    threads.emplace_back([&append, thread, per_thread] {
+      for (size_t i = 0; i < per_thread; ++i) {
+        append(thread * per_thread + i);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return timer.ElapsedNs() / (threads_cnt * per_thread);
+}
+
+int main(int argc, char* argv[]) {
+  const size_t total = argc > 1 ? strtoull(argv[1], nullptr, 10) : (1 << 22);
+  const size_t max_threads = argc > 2 ? strtoull(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+
+  for (size_t threads_cnt = 1; threads_cnt <= std::max<size_t>(max_threads, 1); threads_cnt *= 2) {
+    const size_t per_thread = total / threads_cnt;
+
+    ConcurrentChunkedVector<uint64_t> concurrent;
+    const double concurrent_ns = MeasureAppends(threads_cnt, per_thread, [&concurrent](const uint64_t value) {
+      concurrent.PushBack(value);
+    });
+
+    std::mutex mutex;
+    Vector<uint64_t, ChunkedStorage> locked;
+    const double locked_ns = MeasureAppends(threads_cnt, per_thread, [&mutex, &locked](const uint64_t value) {
+      std::lock_guard<std::mutex> lock(mutex);
+      locked.PushBack(value);
+    });
+
+    printf("%3zu threads: ConcurrentChunkedVector %6.2f ns/push, mutex + ChunkedStorage %6.2f ns/push\n",
+           threads_cnt, concurrent_ns, locked_ns);
+    DoNotOptimize(concurrent.Size() + locked.Size());
+  }
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Each policy runs in its own child process, so ru_maxrss reported by wait4 is that policy's peak.
+
+template<template<typename StorageT, size_t StorageSize> class Storage>
+double RunWorkload(const size_t big_size, const size_t small_cnt, const size_t small_size) {
+  BenchTimer timer;
+
+  Vector<int, Storage> big;
+  for (size_t i = 0; i < big_size; ++i) {
+    big.PushBack(static_cast<int>(i));
+  }
+
+  Vector<Vector<int, Storage>> smalls;
+  for (size_t i = 0; i < small_cnt; ++i) {
+    smalls.PushBack(Vector<int, Storage>());
+    for (size_t j = 0; j < small_size; ++j) {
+      smalls.Back().PushBack(static_cast<int>(j));
+    }
+  }
+
+  DoNotOptimize(big.Size() + smalls.Size());
+  return timer.ElapsedNs();
+}
+
+template<template<typename StorageT, size_t StorageSize> class Storage>
+void BenchPolicy(const char* name, const size_t big_size, const size_t small_cnt, const size_t small_size) {
+  int fds[2] = {};
+  if (pipe(fds) != 0) {
+    perror("pipe");
+    return;
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    double elapsed = RunWorkload<Storage>(big_size, small_cnt, small_size);
+    ssize_t written = write(fds[1], &elapsed, sizeof(elapsed));
+    _exit(written == sizeof(elapsed) ? 0 : 1);
+  }
+  close(fds[1]);
+
+  double elapsed = 0;
+  ssize_t was_read = read(fds[0], &elapsed, sizeof(elapsed));
+  close(fds[0]);
+
+  int status = 0;
+  struct rusage usage = {};
+  wait4(pid, &status, 0, &usage);
+  if (was_read != sizeof(elapsed) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    printf("%-12s failed\n", name);
+    return;
+  }
+
+  const size_t pushed = big_size + small_cnt * small_size;
+  printf("%-12s peak rss %8ld KiB, %8.2f ns/push back\n", name, usage.ru_maxrss, elapsed / pushed);
+}
+
+int main(int argc, char* argv[]) {
+  const size_t big_size   = argc > 1 ? strtoull(argv[1], nullptr, 10) : (1 << 25);
+  const size_t small_cnt  = argc > 2 ? strtoull(argv[2], nullptr, 10) : (1 << 17);
+  const size_t small_size = argc > 3 ? strtoull(argv[3], nullptr, 10) : 100;
+
+  printf("one vector of %zu ints, %zu vectors of %zu ints\n", big_size, small_cnt, small_size);
+  BenchPolicy<DynamicStorage>("2x", big_size, small_cnt, small_size);
+  BenchPolicy<HalfGrowthStorage>("1.5x", big_size, small_cnt, small_size);
+  BenchPolicy<SizeClassStorage>("size class", big_size, small_cnt, small_size);
+  BenchPolicy<PageRoundedStorage>("page", big_size, small_cnt, small_size);
+
+  return 0;
+}
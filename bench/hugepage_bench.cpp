@@ -0,0 +1,69 @@
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+// Huge pages only pay off once the buffer is far larger than what the TLB covers with
+// 4 KiB pages, so the default size is 512 MiB of doubles.
+
+static size_t AnonHugePagesKb() {
+  FILE* file = fopen("/proc/self/smaps_rollup", "r");
+  if (file == nullptr) {
+    return 0;
+  }
+  char line[256];
+  size_t kb = 0;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    if (strncmp(line, "AnonHugePages:", 14) == 0) {
+      kb = strtoull(line + 14, nullptr, 10);
+    }
+  }
+  fclose(file);
+  return kb;
+}
+
+template<template<typename StorageT, size_t StorageSize> class Storage>
+void BenchStorage(const char* name, const size_t size, const size_t accesses) {
+  const size_t huge_before = AnonHugePagesKb();
+  Vector<double, Storage> vector(size);
+  for (size_t i = 0; i < size; ++i) {
+    vector[i] = static_cast<double>(i);
+  }
+  const size_t huge_after = AnonHugePagesKb();
+  const size_t huge_kb = huge_after - std::min(huge_after, huge_before);
+
+  const double random_ns = MeasureNs(3, [&] {
+    uint64_t state = 88172645463325252ull;
+    double sum = 0;
+    for (size_t i = 0; i < accesses; ++i) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      sum += vector.At(state % size);
+    }
+    DoNotOptimize(sum);
+  }) / accesses;
+
+  const double sequential_ns = MeasureNs(3, [&] {
+    double sum = 0;
+    for (const double value : vector) {
+      sum += value;
+    }
+    DoNotOptimize(sum);
+  }) / size;
+
+  printf("%-16s random %6.2f ns/access, sequential %6.3f ns/elem, data %% 64 = %2zu, huge pages %zu MiB\n",
+         name, random_ns, sequential_ns, reinterpret_cast<uintptr_t>(vector.Data()) % 64, huge_kb / 1024);
+}
+
+int main(int argc, char* argv[]) {
+  const size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t{1} << 26);
+  const size_t accesses = argc > 2 ? strtoull(argv[2], nullptr, 10) : (size_t{1} << 24);
+
+  BenchStorage<DynamicStorage>("DynamicStorage", size, accesses);
+  BenchStorage<AlignedStorage>("AlignedStorage", size, accesses);
+  BenchStorage<HugePageStorage>("HugePageStorage", size, accesses);
+
+  return 0;
+}
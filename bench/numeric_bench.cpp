@@ -0,0 +1,52 @@
+#include "numeric_algorithms.hpp"
+#include "bench_utils.hpp"
+
+#include <numeric>
+
+template<typename ElemT, template<typename StorageT, size_t StorageSize> class Storage>
+void BenchStorage(const char* name, const size_t size) {
+  Vector<ElemT, Storage> lhs(size);
+  Vector<ElemT, Storage> rhs(size);
+  for (size_t i = 0; i < size; ++i) {
+    lhs.At(i) = static_cast<ElemT>(i % 7);
+    rhs.At(i) = static_cast<ElemT>(i % 5);
+  }
+
+  const double iter_sum = MeasureNs(5, [&] {
+    DoNotOptimize(std::accumulate(lhs.begin(), lhs.end(), ElemT{0}));
+  });
+  const double simd_sum = MeasureNs(5, [&] {
+    DoNotOptimize(Sum(lhs));
+  });
+  const double iter_dot = MeasureNs(5, [&] {
+    DoNotOptimize(std::inner_product(lhs.begin(), lhs.end(), rhs.begin(), ElemT{0}));
+  });
+  const double simd_dot = MeasureNs(5, [&] {
+    DoNotOptimize(Dot(lhs, rhs));
+  });
+  const double simd_axpy = MeasureNs(5, [&] {
+    Axpy(lhs, ElemT{1}, rhs);
+    DoNotOptimize(lhs.At(0));
+  });
+
+  printf("%-16s sum: iterators %6.3f ns/elem, simd %6.3f ns/elem; dot: iterators %6.3f, simd %6.3f; "
+         "axpy simd %6.3f\n",
+         name, iter_sum / size, simd_sum / size, iter_dot / size, simd_dot / size, simd_axpy / size);
+}
+
+template<typename ElemT>
+void BenchElemType(const char* elem_name, const size_t size) {
+  printf("%s\n", elem_name);
+  BenchStorage<ElemT, DynamicStorage>("DynamicStorage", size);
+  BenchStorage<ElemT, ChunkedStorage>("ChunkedStorage", size);
+}
+
+int main(int argc, char* argv[]) {
+  const size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : (1 << 22);
+
+  BenchElemType<int>("int", size);
+  BenchElemType<float>("float", size);
+  BenchElemType<double>("double", size);
+
+  return 0;
+}
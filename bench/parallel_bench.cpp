@@ -0,0 +1,65 @@
+#include "parallel_algorithms.hpp"
+#include "bench_utils.hpp"
+
+#include <cstdlib>
+#include <algorithm>
+
+// Usage: parallel_bench [size [max_threads]]. Sizes up to 10^9 need about 8 GiB per vector
+// of uint64_t plus the same again for the sort buffer.
+
+// Doubles the thread count, then ends on max_threads itself when it is not a power of two.
+inline size_t NextThreadsCnt(const size_t threads, const size_t max_threads) {
+  return threads == max_threads ? max_threads + 1 : std::min(threads * 2, max_threads);
+}
+
+template<template<typename StorageT, size_t StorageSize> class Storage>
+void BenchStorage(const char* name, const size_t size, const size_t max_threads) {
+  Vector<uint64_t, Storage> vector(size);
+  Vector<uint64_t, Storage> squares(size);
+  uint64_t state = 88172645463325252ull;
+  for (size_t i = 0; i < size; ++i) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    vector.At(i) = state;
+  }
+  const Vector<uint64_t, Storage> unsorted = vector;
+
+  printf("%s, %zu elements\n", name, size);
+  double base_sort = 0;
+  for (size_t threads = 1; threads <= max_threads; threads = NextThreadsCnt(threads, max_threads)) {
+    ThreadPool pool(threads);
+
+    const double for_each = MeasureNs(3, [&] {
+      ParallelForEach(vector, [](uint64_t& elem) { elem = elem * 3 + 1; }, pool);
+    });
+    const double transform = MeasureNs(3, [&] {
+      ParallelTransform(vector, squares, [](const uint64_t elem) { return elem * elem; }, pool);
+    });
+    const double reduce = MeasureNs(3, [&] {
+      DoNotOptimize(ParallelReduce(vector, uint64_t{0}, std::plus<>{}, pool));
+    });
+    // The copy back to unsorted order runs on one thread, so it stays outside the timing.
+    const double sort = MeasureNs(1, [&] {
+      return unsorted;
+    }, [&pool](Vector<uint64_t, Storage>& sorted) {
+      ParallelSort(sorted, std::less<>{}, pool);
+    });
+    if (threads == 1) {
+      base_sort = sort;
+    }
+
+    printf("  %3zu threads: for_each %6.3f ns/elem, transform %6.3f, reduce %6.3f, sort %7.2f (x%.2f)\n",
+           threads, for_each / size, transform / size, reduce / size, sort / size, base_sort / sort);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  const size_t max_threads = argc > 2 ? strtoull(argv[2], nullptr, 10) : ThreadPool::DefaultThreadsCnt();
+
+  BenchStorage<DynamicStorage>("DynamicStorage", size, max_threads);
+  BenchStorage<ChunkedStorage>("ChunkedStorage", size, max_threads);
+
+  return 0;
+}
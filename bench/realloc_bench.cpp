@@ -0,0 +1,67 @@
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+struct Point {
+  Point() {}
+  Point(int x, int y) : x_{x}, y_{y} {}
+
+  int x_ = 0;
+  int y_ = 0;
+};
+
+template<typename ElemT>
+void BenchBufferMove(const char* name, const size_t size) {
+  std::allocator<ElemT> allocator;
+  ElemT* src = allocator.allocate(size);
+  DefaultConstruct(src, size);
+
+  double before = MeasureNs(10, [&] {
+    ElemT* dst = SafeMoveElementwise(allocator, src, 2 * size, size);
+    DoNotOptimize(dst);
+    DestructAndDelete(allocator, dst, size, 2 * size);
+  });
+
+  double after = MeasureNs(10, [&] {
+    ElemT* dst = SafeMove(allocator, src, 2 * size, size);
+    DoNotOptimize(dst);
+    DestructAndDelete(allocator, dst, size, 2 * size);
+  });
+
+  printf("%-14s %10zu elems: elementwise %12.0f ns, bulk %12.0f ns, x%.2f\n",
+         name, size, before, after, before / after);
+
+  DestructAndDelete(allocator, src, size, size);
+}
+
+template<typename VectorT, typename MakeT>
+void BenchPushBack(const char* name, const size_t size, MakeT&& make) {
+  double elapsed = MeasureNs(5, [&] {
+    VectorT vector;
+    for (size_t i = 0; i < size; ++i) {
+      vector.PushBack(make(i));
+    }
+    DoNotOptimize(vector.Size());
+  });
+
+  printf("%-22s %10zu push backs: %12.0f ns (%.2f ns/elem)\n", name, size, elapsed, elapsed / size);
+}
+
+int main() {
+  for (size_t size = 1 << 10; size <= (1 << 22); size <<= 4) {
+    BenchBufferMove<int>("int", size);
+    BenchBufferMove<Point>("Point", size);
+  }
+
+  const size_t PUSH_BACK_CNT = 1 << 22;
+  BenchPushBack<Vector<int>>("Vector<int>", PUSH_BACK_CNT, [](size_t i) {
+    return static_cast<int>(i);
+  });
+  BenchPushBack<Vector<Point>>("Vector<Point>", PUSH_BACK_CNT, [](size_t i) {
+    return Point(static_cast<int>(i), static_cast<int>(i));
+  });
+  BenchPushBack<Vector<Vector<int>>>("Vector<Vector<int>>", PUSH_BACK_CNT / 16, [](size_t) {
+    return Vector<int>();
+  });
+
+  return 0;
+}
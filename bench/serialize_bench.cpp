@@ -0,0 +1,99 @@
+#include "vector_serialization.hpp"
+#include "bench_utils.hpp"
+
+#include <cstdlib>
+#include <string>
+
+// The per-element baseline is what the pipeline stages did before: one buffered fwrite or
+// fread per element of every inner vector.
+template<typename ElemT>
+void WriteElementwise(FILE* file, const Vector<Vector<ElemT>>& nested) {
+  const size_t count = nested.Size();
+  fwrite(&count, sizeof(count), 1, file);
+  for (const Vector<ElemT>& inner : nested) {
+    const size_t size = inner.Size();
+    fwrite(&size, sizeof(size), 1, file);
+    for (const ElemT& elem : inner) {
+      fwrite(&elem, sizeof(elem), 1, file);
+    }
+  }
+  fflush(file);
+}
+
+template<typename ElemT>
+Vector<Vector<ElemT>> ReadElementwise(FILE* file) {
+  size_t count = 0;
+  DoNotOptimize(fread(&count, sizeof(count), 1, file));
+  Vector<Vector<ElemT>> nested;
+  for (size_t i = 0; i < count; ++i) {
+    size_t size = 0;
+    DoNotOptimize(fread(&size, sizeof(size), 1, file));
+    Vector<ElemT> inner;
+    for (size_t j = 0; j < size; ++j) {
+      ElemT elem;
+      DoNotOptimize(fread(&elem, sizeof(elem), 1, file));
+      inner.PushBack(elem);
+    }
+    nested.PushBack(std::move(inner));
+  }
+  return nested;
+}
+
+int main(int argc, char* argv[]) {
+  const size_t rows = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000;
+  const size_t row_size = argc > 2 ? strtoull(argv[2], nullptr, 10) : 200;
+
+  Vector<Vector<int>> nested;
+  for (size_t i = 0; i < rows; ++i) {
+    nested.PushBack(Vector<int>(row_size, static_cast<int>(i)));
+  }
+  const size_t values = rows * row_size;
+
+  const std::string path = "/tmp/serialize_bench_" + std::to_string(getpid()) + ".bin";
+  FILE* file = fopen(path.c_str(), "w+b");
+  unlink(path.c_str());
+  if (file == nullptr) {
+    perror("fopen");
+    return 1;
+  }
+  const int fd = fileno(file);
+
+  auto rewind_file = [&] {
+    fseek(file, 0, SEEK_SET);
+    lseek(fd, 0, SEEK_SET);
+  };
+
+  const double write_elementwise = MeasureNs(3, [&] {
+    rewind_file();
+    WriteElementwise(file, nested);
+  }) / values;
+  const double read_elementwise = MeasureNs(3, [&] {
+    rewind_file();
+    DoNotOptimize(ReadElementwise<int>(file).Size());
+  }) / values;
+
+  const double write_to = MeasureNs(3, [&] {
+    rewind_file();
+    WriteTo(fd, nested);
+  }) / values;
+  const double read_from = MeasureNs(3, [&] {
+    rewind_file();
+    DoNotOptimize(ReadFrom<Vector<Vector<int>>>(fd).Size());
+  }) / values;
+
+  const size_t bytes = SerializedBytes(nested);
+  MappedRegion mapped(FileDescriptor(dup(fd)), bytes, false);
+  const double view = MeasureNs(3, [&] {
+    const auto rows_view = View<Vector<Vector<int>>>(mapped.Data());
+    long long sum = 0;
+    for (size_t i = 0; i < rows_view.Size(); ++i) {
+      sum += rows_view[i][0];
+    }
+    DoNotOptimize(sum);
+  }) / values;
+
+  printf("%zu x %zu ints: element-wise write %6.2f ns/elem, read %6.2f; WriteTo %6.2f, ReadFrom %6.2f, View %6.3f\n",
+         rows, row_size, write_elementwise, read_elementwise, write_to, read_from, view);
+  fclose(file);
+  return 0;
+}
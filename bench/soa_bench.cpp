@@ -0,0 +1,56 @@
+#include "soa_vector.hpp"
+#include "numeric_algorithms.hpp"
+#include "bench_utils.hpp"
+
+#include <cstdlib>
+
+struct Particle {
+  float x;
+  float y;
+  float z;
+  float mass;
+};
+
+template<>
+struct SoaLayout<Particle> {
+  static constexpr auto MEMBERS = std::make_tuple(&Particle::x, &Particle::y, &Particle::z, &Particle::mass);
+};
+
+int main(int argc, char* argv[]) {
+  const size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t{1} << 24);
+
+  Vector<Particle> rows;
+  SoaVector<Particle> columns;
+  rows.Reserve(size);
+  columns.Reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    const Particle particle{static_cast<float>(i % 1000), 1.0f, 2.0f, 3.0f};
+    rows.PushBack(particle);
+    columns.PushBack(particle);
+  }
+
+  const double aos_ns = MeasureNs(5, [&] {
+    const Particle* data = rows.Data();
+    float sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+      sum += data[i].x;
+    }
+    DoNotOptimize(sum);
+  }) / size;
+
+  const double soa_ns = MeasureNs(5, [&] {
+    float sum = 0;
+    for (const float x : columns.ColumnSpan<0>()) {
+      sum += x;
+    }
+    DoNotOptimize(sum);
+  }) / size;
+
+  const double soa_simd_ns = MeasureNs(5, [&] {
+    DoNotOptimize(Sum(columns.Column<0>()));
+  }) / size;
+
+  printf("sum of x over %zu particles: Vector<Particle> %6.3f ns/elem, SoaVector column %6.3f, SIMD Sum %6.3f\n",
+         size, aos_ns, soa_ns, soa_simd_ns);
+  return 0;
+}
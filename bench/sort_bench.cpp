@@ -0,0 +1,71 @@
+#include "radix_sort.hpp"
+#include "bench_utils.hpp"
+
+#include <cstdlib>
+
+template<typename ElemT>
+ElemT NextValue(uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  if constexpr (std::is_floating_point_v<ElemT>) {
+    return static_cast<ElemT>(static_cast<int64_t>(state)) / 1e9;
+  } else {
+    return static_cast<ElemT>(state);
+  }
+}
+
+template<typename ElemT, template<typename StorageT, size_t StorageSize> class Storage>
+void BenchStorage(const char* name, const size_t size, ThreadPool& pool) {
+  Vector<ElemT, Storage> unsorted(size);
+  uint64_t state = 88172645463325252ull;
+  for (size_t i = 0; i < size; ++i) {
+    unsorted.At(i) = NextValue<ElemT>(state);
+  }
+
+  Vector<ElemT, Storage> vector;
+  auto measure = [&](auto&& sort) {
+    return MeasureNs(3, [&] {
+      vector = unsorted;
+      sort();
+    }) / size;
+  };
+
+  const double std_sort = measure([&] {
+    std::sort(vector.begin(), vector.end());
+  });
+  const double radix = measure([&] {
+    RadixSort(vector);
+  });
+  const double stable_radix = measure([&] {
+    StableRadixSort(vector);
+  });
+  const double parallel_sort = measure([&] {
+    ParallelSort(vector, std::less<>{}, pool);
+  });
+  const double parallel_radix = measure([&] {
+    RadixSort(vector, pool);
+  });
+
+  printf("%-16s std::sort %6.2f ns/elem, radix %6.2f, stable radix %6.2f; %zu threads: sort %6.2f, radix %6.2f\n",
+         name, std_sort, radix, stable_radix, pool.ThreadsCnt(), parallel_sort, parallel_radix);
+}
+
+template<typename ElemT>
+void BenchElemType(const char* elem_name, const size_t size, ThreadPool& pool) {
+  printf("%s\n", elem_name);
+  BenchStorage<ElemT, DynamicStorage>("DynamicStorage", size, pool);
+  BenchStorage<ElemT, ChunkedStorage>("ChunkedStorage", size, pool);
+}
+
+int main(int argc, char* argv[]) {
+  const size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : 4000000;
+  ThreadPool pool(argc > 2 ? strtoull(argv[2], nullptr, 10) : ThreadPool::DefaultThreadsCnt());
+
+  BenchElemType<uint32_t>("uint32_t", size, pool);
+  BenchElemType<int64_t>("int64_t", size, pool);
+  BenchElemType<float>("float", size, pool);
+  BenchElemType<double>("double", size, pool);
+
+  return 0;
+}
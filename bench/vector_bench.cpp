@@ -0,0 +1,222 @@
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Runs the same workloads over each storage policy and over std::vector, and prints one
+// JSON document on stdout:
+// {"size": 1048576, "repeats": 5, "results": [
+//   {"container": "std::vector<int>", "workload": "push_back", "size": 1048576, "ops": 1048576, "ns_per_op": 1.23},
+//   ...]}
+// An op is one element for every workload except move, where it is one whole-container move.
+// Usage: vector_bench [size [repeats]]. The StaticStorage runs use min(size, 65536) elements,
+// and std::vector runs once more at that size, as "std::vector<int> (static size)".
+
+static constexpr size_t STATIC_CAPACITY = size_t{1} << 16;
+static constexpr size_t NESTED_ROW_SIZE = 64;
+
+class JsonResults {
+ public:
+  JsonResults(const size_t size, const size_t repeats) {
+    printf("{\"size\": %zu, \"repeats\": %zu, \"results\": [", size, repeats);
+  }
+
+  ~JsonResults() {
+    printf("\n]}\n");
+  }
+
+  // A record with no ops has no per-op time, and JSON has no inf: ns_per_op is null then.
+  void Add(const char* container, const char* workload, const size_t size, const size_t ops, const double ns) {
+    printf("%s\n  {\"container\": \"%s\", \"workload\": \"%s\", \"size\": %zu, \"ops\": %zu, \"ns_per_op\": ",
+           first_ ? "" : ",", container, workload, size, ops);
+    if (ops == 0) {
+      printf("null}");
+    } else {
+      printf("%.4f}", ns / ops);
+    }
+    first_ = false;
+  }
+
+ private:
+  bool first_{true};
+
+};
+
+// std::vector and Vector spell the same operations differently.
+
+template<typename ContainerT>
+inline size_t SizeOf(const ContainerT& container) {
+  if constexpr (requires { container.size(); }) {
+    return container.size();
+  } else {
+    return container.Size();
+  }
+}
+
+template<typename ContainerT, typename ValueT>
+inline void Append(ContainerT& container, const ValueT value) {
+  if constexpr (requires { container.push_back(value); }) {
+    container.push_back(value);
+  } else {
+    container.PushBack(value);
+  }
+}
+
+template<typename ContainerT>
+inline void ShrinkToFit(ContainerT& container) {
+  if constexpr (requires { container.shrink_to_fit(); }) {
+    container.shrink_to_fit();
+  } else {
+    container.Shrink();
+  }
+}
+
+template<typename ContainerT>
+inline void ResizeTo(ContainerT& container, const size_t size) {
+  if constexpr (requires { container.resize(size); }) {
+    container.resize(size);
+  } else {
+    container.Resize(size);
+  }
+}
+
+inline uint64_t NextRandom(uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+template<typename ContainerT>
+ContainerT MakeFilled(const size_t size) {
+  using ValueT = typename ContainerT::value_type;
+  ContainerT container;
+  uint64_t state = 88172645463325252ull;
+  for (size_t i = 0; i < size; ++i) {
+    Append(container, static_cast<ValueT>(NextRandom(state)));
+  }
+  return container;
+}
+
+template<typename ContainerT>
+void BenchContainer(JsonResults& results, const char* name, const size_t size, const size_t repeats) {
+  using ValueT = typename ContainerT::value_type;
+  auto report = [&](const char* workload, const size_t ops, const double ns) {
+    results.Add(name, workload, size, ops, ns);
+  };
+
+  report("push_back", size, MeasureNs(repeats, [&] {
+    ContainerT container;
+    for (size_t i = 0; i < size; ++i) {
+      Append(container, static_cast<ValueT>(i));
+    }
+    DoNotOptimize(SizeOf(container));
+  }));
+
+  const ContainerT filled = MakeFilled<ContainerT>(size);
+
+  report("random_access", size, MeasureNs(repeats, [&] {
+    uint64_t state = 2463534242ull;
+    size_t sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+      sum += static_cast<size_t>(static_cast<ValueT>(filled[NextRandom(state) % size]));
+    }
+    DoNotOptimize(sum);
+  }));
+
+  report("iterate", size, MeasureNs(repeats, [&] {
+    size_t sum = 0;
+    for (const auto value : filled) {
+      sum += static_cast<size_t>(static_cast<ValueT>(value));
+    }
+    DoNotOptimize(sum);
+  }));
+
+  if constexpr (!std::is_same_v<ValueT, bool>) {
+    report("sort", size, MeasureNs(repeats, [&] {
+      return filled;
+    }, [](ContainerT& container) {
+      std::sort(container.begin(), container.end());
+      DoNotOptimize(container[0]);
+    }));
+  }
+
+  report("copy", size, MeasureNs(repeats, [&] {
+    ContainerT copy = filled;
+    DoNotOptimize(SizeOf(copy));
+  }));
+
+  // Moves there and back, so the elements are freed with the state, outside the timed part.
+  report("move", 2, MeasureNs(repeats, [&] {
+    return filled;
+  }, [](ContainerT& container) {
+    ContainerT moved = std::move(container);
+    DoNotOptimize(SizeOf(moved));
+    container = std::move(moved);
+  }));
+
+  report("shrink", size / 2, MeasureNs(repeats, [&] {
+    ContainerT container = filled;
+    ResizeTo(container, size / 2);
+    return container;
+  }, [](ContainerT& container) {
+    ShrinkToFit(container);
+    DoNotOptimize(SizeOf(container));
+  }));
+}
+
+// Rows of NESTED_ROW_SIZE ints pushed one by one into an outer vector, then summed.
+template<typename OuterT>
+void BenchNested(JsonResults& results, const char* name, const size_t size, const size_t repeats) {
+  using InnerT = typename OuterT::value_type;
+  const size_t rows = size / NESTED_ROW_SIZE;
+  results.Add(name, "nested", size, rows * NESTED_ROW_SIZE, MeasureNs(repeats, [&] {
+    OuterT outer;
+    for (size_t row = 0; row < rows; ++row) {
+      InnerT inner;
+      for (size_t i = 0; i < NESTED_ROW_SIZE; ++i) {
+        Append(inner, static_cast<int>(row + i));
+      }
+      Append(outer, std::move(inner));
+    }
+
+    size_t sum = 0;
+    for (const InnerT& inner : outer) {
+      for (const int value : inner) {
+        sum += value;
+      }
+    }
+    DoNotOptimize(sum);
+  }));
+}
+
+int main(int argc, char* argv[]) {
+  const size_t size = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t{1} << 20);
+  const size_t repeats = argc > 2 ? strtoull(argv[2], nullptr, 10) : 5;
+  if (size < NESTED_ROW_SIZE || repeats == 0) {
+    fprintf(stderr, "usage: %s [size [repeats]], size at least %zu and repeats positive\n", argv[0], NESTED_ROW_SIZE);
+    return 1;
+  }
+  const size_t static_size = std::min(size, STATIC_CAPACITY);
+
+  JsonResults results(size, repeats);
+
+  BenchContainer<std::vector<int>>(results, "std::vector<int>", size, repeats);
+  BenchContainer<Vector<int>>(results, "Vector<int, DynamicStorage>", size, repeats);
+  BenchContainer<Vector<int, ChunkedStorage>>(results, "Vector<int, ChunkedStorage>", size, repeats);
+  BenchContainer<std::vector<int>>(results, "std::vector<int> (static size)", static_size, repeats);
+  BenchContainer<Vector<int, StaticStorage, STATIC_CAPACITY>>(results, "Vector<int, StaticStorage>", static_size, repeats);
+
+  BenchContainer<std::vector<bool>>(results, "std::vector<bool>", size, repeats);
+  BenchContainer<Vector<bool>>(results, "Vector<bool, DynamicStorage>", size, repeats);
+  BenchContainer<Vector<bool, ChunkedStorage>>(results, "Vector<bool, ChunkedStorage>", size, repeats);
+
+  BenchNested<std::vector<std::vector<int>>>(results, "std::vector<std::vector<int>>", size, repeats);
+  BenchNested<Vector<Vector<int>>>(results, "Vector<Vector<int>>", size, repeats);
+  BenchNested<Vector<Vector<int, ChunkedStorage>, ChunkedStorage>>(results, "Vector<Vector<int, ChunkedStorage>, ChunkedStorage>",
+                                                                   size, repeats);
+
+  return 0;
+}
@@ -0,0 +1,473 @@
+#ifndef ALLOCATORS_HPP
+#define ALLOCATORS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <new>
+#include <algorithm>
+#include <cstring>
+#include <bit>
+#include <sys/mman.h>
+#include "dynamic_storage.hpp"
+#include "resource_scope.hpp"
+
+// MonotonicArena
+
+class MonotonicArena {
+ public:
+  explicit MonotonicArena(const size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_{block_size} {
+  }
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  ~MonotonicArena() {
+    Release();
+  }
+
+  void* Allocate(const size_t bytes, const size_t alignment) {
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cur_) + alignment - 1) & ~(alignment - 1);
+    if (cur_ == nullptr || aligned + bytes > reinterpret_cast<uintptr_t>(end_)) {
+      AddBlock(bytes + alignment);
+      aligned = (reinterpret_cast<uintptr_t>(cur_) + alignment - 1) & ~(alignment - 1);
+    }
+
+    cur_ = reinterpret_cast<char*>(aligned + bytes);
+    bytes_allocated_ += bytes;
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  // Frees every block at once; memory handed out before becomes invalid.
+  void Release() {
+    while (head_ != nullptr) {
+      Block* next = head_->next;
+      ::operator delete(head_);
+      head_ = next;
+    }
+    cur_ = nullptr;
+    end_ = nullptr;
+    blocks_cnt_ = 0;
+    bytes_allocated_ = 0;
+  }
+
+  [[nodiscard]] inline size_t BlocksCnt() const {
+    return blocks_cnt_;
+  }
+
+  [[nodiscard]] inline size_t BytesAllocated() const {
+    return bytes_allocated_;
+  }
+
+ private:
+  struct Block {
+    Block* next;
+  };
+
+  void AddBlock(const size_t min_bytes) {
+    const size_t bytes = std::max(block_size_, min_bytes + sizeof(Block));
+    Block* block = static_cast<Block*>(::operator new(bytes));
+    block->next = head_;
+    head_ = block;
+
+    cur_ = reinterpret_cast<char*>(block + 1);
+    end_ = reinterpret_cast<char*>(block) + bytes;
+    ++blocks_cnt_;
+  }
+
+ private:
+  static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  size_t block_size_;
+
+  Block* head_{nullptr};
+  char* cur_{nullptr};
+  char* end_{nullptr};
+
+  size_t blocks_cnt_{0};
+  size_t bytes_allocated_{0};
+
+};
+
+// SizeClassPool
+
+// Serves power-of-two size classes from slabs and keeps freed blocks on per-class free lists.
+// Requests above MAX_CLASS_SIZE go straight to ::operator new.
+class SizeClassPool {
+ public:
+  SizeClassPool() = default;
+
+  SizeClassPool(const SizeClassPool&) = delete;
+  SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+  ~SizeClassPool() {
+    Release();
+  }
+
+  void* Allocate(const size_t bytes) {
+    if (bytes > MAX_CLASS_SIZE) {
+      return ::operator new(bytes);
+    }
+
+    const size_t class_num = ClassNum(bytes);
+    FreeNode*& free_list = free_lists_[class_num];
+    if (free_list == nullptr) {
+      RefillClass(class_num);
+    }
+
+    FreeNode* node = free_list;
+    free_list = node->next;
+    return node;
+  }
+
+  void Deallocate(void* ptr, const size_t bytes) {
+    if (ptr == nullptr) {
+      return;
+    }
+
+    if (bytes > MAX_CLASS_SIZE) {
+      ::operator delete(ptr);
+      return;
+    }
+
+    FreeNode*& free_list = free_lists_[ClassNum(bytes)];
+    FreeNode* node = static_cast<FreeNode*>(ptr);
+    node->next = free_list;
+    free_list = node;
+  }
+
+  // Frees every slab at once; blocks handed out before become invalid.
+  void Release() {
+    while (slabs_ != nullptr) {
+      FreeNode* next = slabs_->next;
+      ::operator delete(slabs_);
+      slabs_ = next;
+    }
+    std::fill(free_lists_, free_lists_ + CLASSES_CNT, nullptr);
+  }
+
+ public:
+  static const size_t MIN_CLASS_SIZE = 16;
+  static const size_t MAX_CLASS_SIZE = 64 * 1024;
+  static const size_t SLAB_SIZE      = 256 * 1024;
+
+ private:
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  static constexpr size_t ClassSize(const size_t class_num) {
+    return MIN_CLASS_SIZE << class_num;
+  }
+
+  static size_t ClassNum(const size_t bytes) {
+    size_t class_num = 0;
+    while (ClassSize(class_num) < bytes) {
+      ++class_num;
+    }
+    return class_num;
+  }
+
+  void RefillClass(const size_t class_num) {
+    const size_t class_size = ClassSize(class_num);
+    // The first MIN_CLASS_SIZE bytes link the slab into slabs_ and keep the blocks aligned.
+    FreeNode* slab = static_cast<FreeNode*>(::operator new(SLAB_SIZE + MIN_CLASS_SIZE));
+    slab->next = slabs_;
+    slabs_ = slab;
+
+    char* first = reinterpret_cast<char*>(slab) + MIN_CLASS_SIZE;
+    FreeNode*& free_list = free_lists_[class_num];
+    for (size_t offset = SLAB_SIZE; offset >= class_size; offset -= class_size) {
+      FreeNode* node = reinterpret_cast<FreeNode*>(first + offset - class_size);
+      node->next = free_list;
+      free_list = node;
+    }
+  }
+
+ private:
+  static const size_t CLASSES_CNT = 13;
+  static_assert((MIN_CLASS_SIZE << (CLASSES_CNT - 1)) == MAX_CLASS_SIZE);
+
+  FreeNode* free_lists_[CLASSES_CNT] = {};
+  FreeNode* slabs_{nullptr};
+
+};
+
+// ArenaAllocator
+
+// Allocates from the arena that was current when it was constructed, or from the heap if none was.
+// deallocate never returns memory to the arena; it is all freed by MonotonicArena::Release.
+template<typename ElemT>
+class ArenaAllocator {
+ public:
+  using value_type = ElemT;
+
+ public:
+  ArenaAllocator() : arena_{ResourceScope<MonotonicArena>::Current()} {
+  }
+
+  template<typename OtherT>
+  ArenaAllocator(const ArenaAllocator<OtherT>& other) : arena_{other.GetArena()} {
+  }
+
+  [[nodiscard]] ElemT* allocate(const size_t n) {
+    if (arena_ == nullptr) {
+      return static_cast<ElemT*>(::operator new(n * sizeof(ElemT)));
+    }
+    return static_cast<ElemT*>(arena_->Allocate(n * sizeof(ElemT), alignof(ElemT)));
+  }
+
+  void deallocate(ElemT* ptr, const size_t /*n*/) {
+    if (arena_ == nullptr) {
+      ::operator delete(ptr);
+    }
+  }
+
+  [[nodiscard]] inline MonotonicArena* GetArena() const {
+    return arena_;
+  }
+
+ private:
+  MonotonicArena* arena_;
+
+};
+
+// PoolAllocator
+
+// Allocates from the pool that was current when it was constructed, or from the heap if none was.
+template<typename ElemT>
+class PoolAllocator {
+ public:
+  using value_type = ElemT;
+
+  static_assert(alignof(ElemT) <= SizeClassPool::MIN_CLASS_SIZE);
+
+ public:
+  PoolAllocator() : pool_{ResourceScope<SizeClassPool>::Current()} {
+  }
+
+  template<typename OtherT>
+  PoolAllocator(const PoolAllocator<OtherT>& other) : pool_{other.GetPool()} {
+  }
+
+  [[nodiscard]] ElemT* allocate(const size_t n) {
+    if (pool_ == nullptr) {
+      return static_cast<ElemT*>(::operator new(n * sizeof(ElemT)));
+    }
+    return static_cast<ElemT*>(pool_->Allocate(n * sizeof(ElemT)));
+  }
+
+  void deallocate(ElemT* ptr, const size_t n) {
+    if (pool_ == nullptr) {
+      ::operator delete(ptr);
+      return;
+    }
+    pool_->Deallocate(ptr, n * sizeof(ElemT));
+  }
+
+  [[nodiscard]] inline SizeClassPool* GetPool() const {
+    return pool_;
+  }
+
+ private:
+  SizeClassPool* pool_;
+
+};
+
+// MallocAllocator
+
+// Goes through malloc/free and offers allocate_zeroed, which DynamicStorage uses for
+// zero-filled construction: calloc gets fresh pages from the OS already zeroed.
+template<typename ElemT>
+class MallocAllocator {
+ public:
+  using value_type = ElemT;
+
+  static_assert(alignof(ElemT) <= alignof(std::max_align_t));
+
+ public:
+  MallocAllocator() = default;
+
+  template<typename OtherT>
+  MallocAllocator(const MallocAllocator<OtherT>&) {
+  }
+
+  [[nodiscard]] ElemT* allocate(const size_t n) {
+    void* ptr = std::malloc(std::max<size_t>(n, 1) * sizeof(ElemT));
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<ElemT*>(ptr);
+  }
+
+  [[nodiscard]] ElemT* allocate_zeroed(const size_t n) {
+    void* ptr = std::calloc(std::max<size_t>(n, 1), sizeof(ElemT));
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<ElemT*>(ptr);
+  }
+
+  void deallocate(ElemT* ptr, const size_t /*n*/) {
+    std::free(ptr);
+  }
+
+};
+
+// AlignedAllocator
+
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Starts every buffer on an Alignment boundary, a cache line by default, so aligned SIMD
+// loads over the elements never straddle two lines.
+template<typename ElemT, size_t Alignment = CACHE_LINE_SIZE>
+class AlignedAllocator {
+ public:
+  using value_type = ElemT;
+
+  template<typename OtherT>
+  struct rebind {
+    using other = AlignedAllocator<OtherT, Alignment>;
+  };
+
+  static_assert(std::has_single_bit(Alignment) && Alignment >= alignof(ElemT));
+
+ public:
+  AlignedAllocator() = default;
+
+  template<typename OtherT>
+  AlignedAllocator(const AlignedAllocator<OtherT, Alignment>&) {
+  }
+
+  [[nodiscard]] ElemT* allocate(const size_t n) {
+    return static_cast<ElemT*>(::operator new(n * sizeof(ElemT), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(ElemT* ptr, const size_t /*n*/) {
+    ::operator delete(ptr, std::align_val_t{Alignment});
+  }
+
+};
+
+// HugePageAllocator
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Buffers of at least HUGE_PAGE_SIZE come from their own anonymous mapping, aligned to
+// HUGE_PAGE_SIZE and marked MADV_HUGEPAGE, so transparent huge pages can back them and a
+// random access needs far fewer TLB entries. Smaller buffers go to AlignedAllocator.
+// Mapped memory is zeroed already, which allocate_zeroed passes on to DynamicStorage.
+template<typename ElemT, size_t Alignment = CACHE_LINE_SIZE>
+class HugePageAllocator {
+ public:
+  using value_type = ElemT;
+
+  template<typename OtherT>
+  struct rebind {
+    using other = HugePageAllocator<OtherT, Alignment>;
+  };
+
+  static_assert(std::has_single_bit(Alignment) && Alignment >= alignof(ElemT) && Alignment <= HUGE_PAGE_SIZE);
+
+ public:
+  HugePageAllocator() = default;
+
+  template<typename OtherT>
+  HugePageAllocator(const HugePageAllocator<OtherT, Alignment>&) {
+  }
+
+  [[nodiscard]] ElemT* allocate(const size_t n) {
+    if (!IsHuge(n)) {
+      return small_.allocate(n);
+    }
+    return static_cast<ElemT*>(MapHuge(MappedBytes(n)));
+  }
+
+  [[nodiscard]] ElemT* allocate_zeroed(const size_t n) {
+    if (!IsHuge(n)) {
+      ElemT* ptr = small_.allocate(n);
+      std::memset(static_cast<void*>(ptr), 0, n * sizeof(ElemT));
+      return ptr;
+    }
+    return allocate(n);
+  }
+
+  void deallocate(ElemT* ptr, const size_t n) {
+    if (!IsHuge(n)) {
+      small_.deallocate(ptr, n);
+      return;
+    }
+    munmap(ptr, MappedBytes(n));
+  }
+
+  [[nodiscard]] static inline bool IsHuge(const size_t n) {
+    return n * sizeof(ElemT) >= HUGE_PAGE_SIZE;
+  }
+
+ private:
+  static inline size_t MappedBytes(const size_t n) {
+    return (n * sizeof(ElemT) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+
+  // Over-maps by one huge page and unmaps whatever lies outside the aligned window.
+  static void* MapHuge(const size_t bytes) {
+    void* raw = mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = (begin + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    if (aligned != begin) {
+      munmap(raw, aligned - begin);
+    }
+    const size_t tail = begin + bytes + HUGE_PAGE_SIZE - (aligned + bytes);
+    if (tail != 0) {
+      munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+    }
+
+    // Only a hint: the kernel may have THP disabled, and the memory is usable either way.
+    madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+ private:
+  [[no_unique_address]] AlignedAllocator<ElemT, Alignment> small_;
+
+};
+
+// Storages
+
+template<typename ElemT, size_t N>
+using ArenaStorage = DynamicStorage<ElemT, N, ArenaAllocator>;
+
+template<typename ElemT, size_t N>
+using PoolStorage = DynamicStorage<ElemT, N, PoolAllocator>;
+
+template<typename ElemT, size_t N>
+using MallocStorage = DynamicStorage<ElemT, N, MallocAllocator>;
+
+// DynamicStorage aligned to a chosen boundary: Vector<double, AlignedTo<128>::Storage>
+template<size_t Alignment>
+struct AlignedTo {
+  template<typename ElemT>
+  using Allocator = AlignedAllocator<ElemT, Alignment>;
+
+  template<typename ElemT>
+  using HugePageAllocator = ::HugePageAllocator<ElemT, Alignment>;
+
+  template<typename ElemT, size_t N>
+  using Storage = DynamicStorage<ElemT, N, Allocator>;
+
+  template<typename ElemT, size_t N>
+  using HugePageStorage = DynamicStorage<ElemT, N, HugePageAllocator>;
+};
+
+template<typename ElemT, size_t N>
+using AlignedStorage = AlignedTo<CACHE_LINE_SIZE>::Storage<ElemT, N>;
+
+template<typename ElemT, size_t N>
+using HugePageStorage = AlignedTo<CACHE_LINE_SIZE>::HugePageStorage<ElemT, N>;
+
+#endif /* allocators.hpp */
@@ -0,0 +1,228 @@
+#ifndef BIT_OPS_HPP
+#define BIT_OPS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+
+#include "cpu_features.hpp"
+
+#if VECTOR_X86_SIMD
+#include <immintrin.h>
+#endif
+
+// Whole-word kernels behind the bulk operations of Vector<bool>. Every kernel has a
+// scalar, an SSE2 and an AVX2 version; the widest one the CPU supports is picked once.
+
+enum class BitOp {
+  AND,
+  OR,
+  XOR,
+  AND_NOT
+};
+
+template<BitOp Op>
+inline uint64_t ApplyBitOp(const uint64_t lhs, const uint64_t rhs) {
+  if constexpr (Op == BitOp::AND) {
+    return lhs & rhs;
+  } else if constexpr (Op == BitOp::OR) {
+    return lhs | rhs;
+  } else if constexpr (Op == BitOp::XOR) {
+    return lhs ^ rhs;
+  } else {
+    return lhs & ~rhs;
+  }
+}
+
+template<BitOp Op>
+void BitOpScalar(uint64_t* dst, const uint64_t* src, const size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = ApplyBitOp<Op>(dst[i], src[i]);
+  }
+}
+
+inline void BitNotScalar(uint64_t* dst, const size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = ~dst[i];
+  }
+}
+
+#if VECTOR_X86_SIMD
+
+template<BitOp Op>
+__attribute__((target("sse2"))) inline __m128i ApplyBitOp128(const __m128i lhs, const __m128i rhs) {
+  if constexpr (Op == BitOp::AND) {
+    return _mm_and_si128(lhs, rhs);
+  } else if constexpr (Op == BitOp::OR) {
+    return _mm_or_si128(lhs, rhs);
+  } else if constexpr (Op == BitOp::XOR) {
+    return _mm_xor_si128(lhs, rhs);
+  } else {
+    return _mm_andnot_si128(rhs, lhs);
+  }
+}
+
+template<BitOp Op>
+__attribute__((target("avx2"))) inline __m256i ApplyBitOp256(const __m256i lhs, const __m256i rhs) {
+  if constexpr (Op == BitOp::AND) {
+    return _mm256_and_si256(lhs, rhs);
+  } else if constexpr (Op == BitOp::OR) {
+    return _mm256_or_si256(lhs, rhs);
+  } else if constexpr (Op == BitOp::XOR) {
+    return _mm256_xor_si256(lhs, rhs);
+  } else {
+    return _mm256_andnot_si256(rhs, lhs);
+  }
+}
+
+template<BitOp Op>
+__attribute__((target("sse2"))) void BitOpSse2(uint64_t* dst, const uint64_t* src, const size_t count) {
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    const __m128i lhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    const __m128i rhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), ApplyBitOp128<Op>(lhs, rhs));
+  }
+  BitOpScalar<Op>(dst + i, src + i, count - i);
+}
+
+template<BitOp Op>
+__attribute__((target("avx2"))) void BitOpAvx2(uint64_t* dst, const uint64_t* src, const size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i lhs0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    const __m256i lhs1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i + 4));
+    const __m256i rhs0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i rhs1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 4));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), ApplyBitOp256<Op>(lhs0, rhs0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 4), ApplyBitOp256<Op>(lhs1, rhs1));
+  }
+  for (; i + 4 <= count; i += 4) {
+    const __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    const __m256i rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), ApplyBitOp256<Op>(lhs, rhs));
+  }
+  BitOpScalar<Op>(dst + i, src + i, count - i);
+}
+
+__attribute__((target("sse2"))) inline void BitNotSse2(uint64_t* dst, const size_t count) {
+  const __m128i ones = _mm_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    const __m128i word = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(word, ones));
+  }
+  BitNotScalar(dst + i, count - i);
+}
+
+__attribute__((target("avx2"))) inline void BitNotAvx2(uint64_t* dst, const size_t count) {
+  const __m256i ones = _mm256_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256i word = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(word, ones));
+  }
+  BitNotScalar(dst + i, count - i);
+}
+
+#endif
+
+// dst[i] = dst[i] Op src[i] for count words.
+template<BitOp Op>
+inline void BitOpWords(uint64_t* dst, const uint64_t* src, const size_t count) {
+  using KernelT = void (*)(uint64_t*, const uint64_t*, size_t);
+#if VECTOR_X86_SIMD
+  static const KernelT kernel = CpuFeatures::Get().avx2 ? BitOpAvx2<Op> :
+                                CpuFeatures::Get().sse2 ? BitOpSse2<Op> : BitOpScalar<Op>;
+#else
+  static const KernelT kernel = BitOpScalar<Op>;
+#endif
+  kernel(dst, src, count);
+}
+
+inline void BitNotWords(uint64_t* dst, const size_t count) {
+  using KernelT = void (*)(uint64_t*, size_t);
+#if VECTOR_X86_SIMD
+  static const KernelT kernel = CpuFeatures::Get().avx2 ? BitNotAvx2 :
+                                CpuFeatures::Get().sse2 ? BitNotSse2 : BitNotScalar;
+#else
+  static const KernelT kernel = BitNotScalar;
+#endif
+  kernel(dst, count);
+}
+
+// Set bits in count words. Baseline x86-64 has no popcnt instruction, so std::popcount
+// alone compiles to a bit-twiddling sequence.
+inline size_t PopcountWordsScalar(const uint64_t* words, const size_t count) {
+  size_t ones = 0;
+  for (size_t i = 0; i < count; ++i) {
+    ones += std::popcount(words[i]);
+  }
+  return ones;
+}
+
+// Maximal runs of set bits in count words.
+inline size_t CountRunsScalar(const uint64_t* words, const size_t count) {
+  if (count == 0) {
+    return 0;
+  }
+
+  size_t runs = std::popcount(words[0] & ~(words[0] << 1));
+  for (size_t i = 1; i < count; ++i) {
+    runs += std::popcount(words[i] & ~((words[i] << 1) | (words[i - 1] >> 63)));
+  }
+  return runs;
+}
+
+#if VECTOR_X86_SIMD
+
+__attribute__((target("popcnt"))) inline size_t PopcountWordsHw(const uint64_t* words, const size_t count) {
+  size_t ones = 0;
+  for (size_t i = 0; i < count; ++i) {
+    ones += __builtin_popcountll(words[i]);
+  }
+  return ones;
+}
+
+__attribute__((target("popcnt"))) inline size_t CountRunsHw(const uint64_t* words, const size_t count) {
+  if (count == 0) {
+    return 0;
+  }
+
+  size_t runs = __builtin_popcountll(words[0] & ~(words[0] << 1));
+  for (size_t i = 1; i < count; ++i) {
+    runs += __builtin_popcountll(words[i] & ~((words[i] << 1) | (words[i - 1] >> 63)));
+  }
+  return runs;
+}
+
+#endif
+
+inline size_t PopcountWords(const uint64_t* words, const size_t count) {
+  using KernelT = size_t (*)(const uint64_t*, size_t);
+#if VECTOR_X86_SIMD
+  static const KernelT kernel = CpuFeatures::Get().popcnt ? PopcountWordsHw : PopcountWordsScalar;
+#else
+  static const KernelT kernel = PopcountWordsScalar;
+#endif
+  return kernel(words, count);
+}
+
+inline size_t CountRuns(const uint64_t* words, const size_t count) {
+  using KernelT = size_t (*)(const uint64_t*, size_t);
+#if VECTOR_X86_SIMD
+  static const KernelT kernel = CpuFeatures::Get().popcnt ? CountRunsHw : CountRunsScalar;
+#else
+  static const KernelT kernel = CountRunsScalar;
+#endif
+  return kernel(words, count);
+}
+
+// Plain stores vectorize on their own.
+inline void BitFillWords(uint64_t* dst, const size_t count, const uint64_t word) {
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = word;
+  }
+}
+
+#endif /* bit_ops.hpp */
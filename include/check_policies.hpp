@@ -0,0 +1,22 @@
+#ifndef CHECK_POLICIES_HPP
+#define CHECK_POLICIES_HPP
+
+// Decide whether Vector::operator[] and the iterators validate indices and throw.
+
+struct AlwaysCheck {
+  static constexpr bool ENABLED = true;
+};
+
+struct DebugCheck {
+#ifdef NDEBUG
+  static constexpr bool ENABLED = false;
+#else
+  static constexpr bool ENABLED = true;
+#endif
+};
+
+struct NeverCheck {
+  static constexpr bool ENABLED = false;
+};
+
+#endif /* check_policies.hpp */
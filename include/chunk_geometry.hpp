@@ -0,0 +1,38 @@
+#ifndef CHUNK_GEOMETRY_HPP
+#define CHUNK_GEOMETRY_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+
+// A geometry tells ChunkedStorage how many elements go into a chunk and how chunks are aligned.
+// Power-of-two chunk sizes turn index arithmetic into a shift and a mask.
+
+// At least 1 KiB and 8 elements per chunk; the element count is not necessarily a power of two.
+struct ByteSizedChunks {
+  template<typename ElemT>
+  static constexpr size_t CHUNK_SIZE = std::max<size_t>(1024, sizeof(ElemT) * 8) / sizeof(ElemT);
+
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+};
+
+template<size_t Log2Size>
+struct PowerOfTwoChunks {
+  template<typename ElemT>
+  static constexpr size_t CHUNK_SIZE = size_t{1} << Log2Size;
+
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+};
+
+// As many elements as fit into PageBytes, rounded down to a power of two, in Alignment-aligned chunks.
+template<size_t PageBytes = 4096, size_t Alignment = 64>
+struct PageChunks {
+  static_assert((Alignment & (Alignment - 1)) == 0);
+
+  template<typename ElemT>
+  static constexpr size_t CHUNK_SIZE = std::bit_floor(std::max<size_t>(1, PageBytes / sizeof(ElemT)));
+
+  static constexpr size_t ALIGNMENT = Alignment;
+};
+
+#endif /* chunk_geometry.hpp */
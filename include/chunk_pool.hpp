@@ -0,0 +1,159 @@
+#ifndef CHUNK_POOL_HPP
+#define CHUNK_POOL_HPP
+
+#include <cstddef>
+#include <cassert>
+#include <utility>
+#include <new>
+
+#include "object_helpers.hpp"
+
+struct ChunkPoolStats {
+  size_t hits{0};
+  size_t misses{0};
+  size_t recycled{0};
+  size_t freed{0};
+
+  [[nodiscard]] inline double HitRate() const {
+    const size_t acquired = hits + misses;
+    return acquired == 0 ? 0.0 : static_cast<double>(hits) / acquired;
+  }
+};
+
+// Keeps up to retention_cap released chunks of ChunkBytes, aligned to Alignment, on a free list and hands them out again
+// instead of going back to the system. Chunks beyond the cap are freed immediately.
+template<size_t ChunkBytes, size_t Alignment = alignof(std::max_align_t)>
+class ChunkPool {
+ public:
+  static_assert(ChunkBytes >= sizeof(void*));
+  static_assert(ChunkBytes % Alignment == 0);
+
+ public:
+  explicit ChunkPool(const size_t retention_cap = DEFAULT_RETENTION_CAP) : retention_cap_{retention_cap} {
+  }
+
+  ChunkPool(const ChunkPool&) = delete;
+  ChunkPool& operator=(const ChunkPool&) = delete;
+
+  ChunkPool(ChunkPool&& other_move) {
+    SwapFields(other_move);
+  }
+
+  ChunkPool& operator=(ChunkPool&& other_move) {
+    if (this == &other_move) {
+      return *this;
+    }
+
+    SwapFields(other_move);
+    return *this;
+  }
+
+  ~ChunkPool() {
+    Trim(0);
+  }
+
+  [[nodiscard]] void* Acquire() {
+    if (free_list_ == nullptr) {
+      ++stats_.misses;
+      return AllocateChunk();
+    }
+
+    ++stats_.hits;
+    FreeChunk* chunk = free_list_;
+    free_list_ = chunk->next;
+    --retained_cnt_;
+    return chunk;
+  }
+
+  void Release(void* chunk) {
+    if (chunk == nullptr) {
+      return;
+    }
+
+    if (retained_cnt_ >= retention_cap_) {
+      ++stats_.freed;
+      FreeChunkMemory(chunk);
+      return;
+    }
+
+    ++stats_.recycled;
+    FreeChunk* free_chunk = static_cast<FreeChunk*>(chunk);
+    free_chunk->next = free_list_;
+    free_list_ = free_chunk;
+    ++retained_cnt_;
+  }
+
+  // Frees retained chunks until at most keep_cnt are left.
+  void Trim(const size_t keep_cnt) {
+    while (retained_cnt_ > keep_cnt) {
+      FreeChunk* next = free_list_->next;
+      FreeChunkMemory(free_list_);
+      free_list_ = next;
+      --retained_cnt_;
+      ++stats_.freed;
+    }
+  }
+
+  void SetRetentionCap(const size_t retention_cap) {
+    retention_cap_ = retention_cap;
+    Trim(retention_cap_);
+  }
+
+  [[nodiscard]] inline size_t RetentionCap() const {
+    return retention_cap_;
+  }
+
+  [[nodiscard]] inline size_t RetainedCnt() const {
+    return retained_cnt_;
+  }
+
+  [[nodiscard]] inline const ChunkPoolStats& Stats() const {
+    return stats_;
+  }
+
+ public:
+  static const size_t DEFAULT_RETENTION_CAP = 8;
+
+ private:
+  struct FreeChunk {
+    FreeChunk* next;
+  };
+
+  static void* AllocateChunk() {
+    if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(ChunkBytes, std::align_val_t{Alignment});
+    } else {
+      return ::operator new(ChunkBytes);
+    }
+  }
+
+  static void FreeChunkMemory(void* chunk) {
+    if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(chunk, std::align_val_t{Alignment});
+    } else {
+      ::operator delete(chunk);
+    }
+  }
+
+  void SwapFields(ChunkPool& other) {
+    std::swap(free_list_, other.free_list_);
+    std::swap(retained_cnt_, other.retained_cnt_);
+    std::swap(retention_cap_, other.retention_cap_);
+    std::swap(stats_, other.stats_);
+  }
+
+ private:
+  FreeChunk* free_list_{nullptr};
+  size_t retained_cnt_{0};
+  size_t retention_cap_{DEFAULT_RETENTION_CAP};
+
+  ChunkPoolStats stats_;
+
+};
+
+// The free list and counters hold no pointers into the pool itself.
+template<size_t ChunkBytes, size_t Alignment>
+struct IsTriviallyRelocatable<ChunkPool<ChunkBytes, Alignment>> : std::true_type {
+};
+
+#endif /* chunk_pool.hpp */
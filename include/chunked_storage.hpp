@@ -1,35 +1,77 @@
 #ifndef CHUNKED_STORAGE_HPP
 #define CHUNKED_STORAGE_HPP
 
+#include <bit>
 #include "dynamic_storage.hpp"
-
-template<typename ElemT, size_t N = 0>
+#include "chunk_pool.hpp"
+#include "chunk_geometry.hpp"
+#include "resource_scope.hpp"
+
+// Elements live in fixed-size chunks that never move. A null chunk below Size() holds copies of
+// value_ that are constructed on first access. Geometry picks the chunk size and alignment. Chunks come from the ChunkPool made current with
+// ResourceScope when the storage was constructed, or from a pool of its own.
+template<typename ElemT, size_t N = 0, typename Geometry = ByteSizedChunks>
 class ChunkedStorage {
+ public:
+  static constexpr size_t FULL_CHUNK_SIZE_ = Geometry::template CHUNK_SIZE<ElemT>;
+  static constexpr size_t ALIGNMENT_ = std::max(Geometry::ALIGNMENT, alignof(ElemT));
+  static constexpr size_t CHUNK_CAP_ =
+    (FULL_CHUNK_SIZE_ * sizeof(ElemT) + ALIGNMENT_ - 1) / ALIGNMENT_ * ALIGNMENT_;
+
+  static_assert(FULL_CHUNK_SIZE_ != 0);
+
+  using Pool = ChunkPool<CHUNK_CAP_, ALIGNMENT_>;
+
  public:
   ChunkedStorage() {
   }
 
-  ChunkedStorage(const size_t size) : chunks_(CalcChunksCnt(size), nullptr) {
+  ChunkedStorage(const size_t size) : chunks_(CalcChunksCnt(size), nullptr), size_{size} {
   }
 
-  ChunkedStorage(const size_t size, const ElemT& value) : size_{size}, value_(value) {
+  ChunkedStorage(const size_t size, const ElemT& value) :
+    chunks_(CalcChunksCnt(size), nullptr), size_{size}, value_(value) {
   }
 
-  ChunkedStorage(const ChunkedStorage& other_copy) = default;
+  ChunkedStorage(const ChunkedStorage& other_copy) :
+    chunks_(other_copy.chunks_.Size(), nullptr),
+    size_{other_copy.size_},
+    value_(other_copy.value_),
+    shared_pool_{other_copy.shared_pool_},
+    own_pool_(other_copy.own_pool_.RetentionCap()) {
+    try {
+      for (size_t i = 0; i < chunks_.Size(); ++i) {
+        const ElemT* other_chunk = other_copy.chunks_.At(i);
+        if (other_chunk == nullptr) {
+          continue;
+        }
+
+        const size_t chunk_size = ChunkElemsCnt(i);
+        ElemT*& chunk = chunks_.At(i);
+        chunk = static_cast<ElemT*>(GetPool().Acquire());
+        size_t constructed = 0;
+        try {
+          for (; constructed < chunk_size; ++constructed) {
+            ConstructOne(chunk + constructed, other_chunk[constructed]);
+          }
+        } catch (...) {
+          Destruct(chunk, constructed);
+          ReleaseChunk(chunk, 0);
+          throw;
+        }
+      }
+    } catch (...) {
+      ReleaseAllChunks();
+      throw;
+    }
+  }
 
   ChunkedStorage(ChunkedStorage&& other_move) {
-    std::swap(chunks_, other_move.chunks_);
-    std::swap(size_, other_move.size_);
-    std::swap(value_, other_move.value_);
+    SwapFields(other_move);
   }
 
   ~ChunkedStorage() {
-    if (chunks_.Size() != 0) {
-      for (size_t i = 0; i < chunks_.Size() - 1; ++i) {
-        DestructAndDeleteChunk(chunks_.At(i), FULL_CHUNK_SIZE_);
-      }
-      DestructAndDeleteChunk(chunks_.At(chunks_.Size() - 1), size_ % FULL_CHUNK_SIZE_);
-    }
+    ReleaseAllChunks();
   }
 
   ChunkedStorage& operator=(const ChunkedStorage& other_copy) {
@@ -47,9 +89,7 @@ class ChunkedStorage {
       return *this;
     }
 
-    std::swap(chunks_, other_move.chunks_);
-    std::swap(size_, other_move.size_);
-    std::swap(value_, other_move.value_);
+    SwapFields(other_move);
     return *this;
   }
 
@@ -59,50 +99,93 @@ class ChunkedStorage {
 
   [[nodiscard]] inline ElemT& At(const size_t index) {
     size_t chunk_num = GetChunkNum(index);
-    size_t chunk_size = GetChunkSize(chunk_num);
     ElemT*& chunk = chunks_.At(chunk_num);
     if (chunk == nullptr) {
-      MakeChunkReady(chunk, chunk_size);
+      MakeChunkReady(chunk, ChunkElemsCnt(chunk_num));
     }
-    return chunk[index % FULL_CHUNK_SIZE_];
+    return chunk[GetChunkOffset(index)];
   }
 
   [[nodiscard]] inline const ElemT& At(const size_t index) const {
     return const_cast<ChunkedStorage*>(this)->At(index);
   }
 
+  // Calls func(chunk, count) for every chunk in index order, constructing lazy chunks on the way.
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    for (size_t i = 0; i < CalcChunksCnt(size_); ++i) {
+      const size_t chunk_size = ChunkElemsCnt(i);
+      ElemT*& chunk = chunks_.At(i);
+      if (chunk == nullptr) {
+        MakeChunkReady(chunk, chunk_size);
+      }
+      if (!CallSegment(func, chunk, chunk_size)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return const_cast<ChunkedStorage*>(this)->ForEachSegment([&func](ElemT* chunk, const size_t count) {
+      return CallSegment(func, static_cast<const ElemT*>(chunk), count);
+    });
+  }
+
+  // New elements are copies of the fill value given to the constructor (ElemT() by default).
   void Resize(const size_t new_size) {
     if (size_ == new_size) {
       return;
     }
 
-    if (new_size == 0) {
-      if (chunks_.Size() != 0) {
-        for (size_t i = 0; i < chunks_.Size() - 1; ++i) {
-          Destruct(chunks_.At(i), FULL_CHUNK_SIZE_);
+    if (new_size < size_) {
+      for (size_t i = GetChunkNum(new_size); i < CalcChunksCnt(size_); ++i) {
+        ElemT* chunk = chunks_.At(i);
+        if (chunk != nullptr) {
+          const size_t first = i == GetChunkNum(new_size) ? GetChunkOffset(new_size) : 0;
+          Destruct(chunk, first, ChunkElemsCnt(i));
         }
-        Destruct(chunks_.At(chunks_.Size() - 1), size_ % FULL_CHUNK_SIZE_);
       }
+      size_ = new_size;
       return;
     }
 
-    if (new_size < size_) {
-      size_t start_chunk_num = GetChunkNum(new_size);
-      Destruct(chunks_.At(start_chunk_num), new_size % FULL_CHUNK_SIZE_);
-      for (size_t i = start_chunk_num + 1; i < chunks_.Size() - 1; ++i) {
-        Destruct(chunks_.At(i), FULL_CHUNK_SIZE_);
+    if (CalcChunksCnt(new_size) > chunks_.Size()) {
+      chunks_.Resize(CalcChunksCnt(new_size));
+    }
+    while (size_ < new_size) {
+      ElemT* chunk = chunks_.At(GetChunkNum(size_));
+      if (chunk != nullptr) {
+        ConstructOne(chunk + GetChunkOffset(size_), value_);
       }
-      Destruct(chunks_.At(chunks_.Size() - 1), size_ % FULL_CHUNK_SIZE_);
-    } else {
-      size_t new_chunks_cnt = GetChunkNum(new_size);
-      chunks_.Resize(new_chunks_cnt);
+      ++size_;
+    }
+  }
+
+  // Like Resize, but new elements get real chunks and are default-initialized instead of being
+  // lazy copies of the fill value, so trivial ones are never written.
+  void ResizeDefaultInit(const size_t new_size) {
+    if (new_size <= size_) {
+      Resize(new_size);
+      return;
+    }
+
+    const size_t used_chunks_cnt = CalcChunksCnt(size_);
+    if (used_chunks_cnt != 0 && chunks_.At(used_chunks_cnt - 1) == nullptr) {
+      MakeChunkReady(chunks_.At(used_chunks_cnt - 1), ChunkElemsCnt(used_chunks_cnt - 1));
     }
+    Reserve(new_size);
 
-    size_ = new_size;
+    while (size_ < new_size) {
+      const size_t chunk_end = std::min(new_size, (GetChunkNum(size_) + 1) * FULL_CHUNK_SIZE_);
+      DefaultInit(chunks_.At(GetChunkNum(size_)), GetChunkOffset(size_), GetChunkOffset(size_) + chunk_end - size_);
+      size_ = chunk_end;
+    }
   }
 
   ElemT* ReserveBack() {
-    size_t chunk_num = GetChunkNum(size_ + 1);
+    size_t chunk_num = GetChunkNum(size_);
 
     assert(chunk_num <= chunks_.Size());
     if (chunk_num == chunks_.Size()) {
@@ -112,76 +195,141 @@ class ChunkedStorage {
     ElemT*& chunk = chunks_.At(chunk_num);
 
     if (chunk == nullptr) {
-      MakeChunkReady(chunk, 0);
+      MakeChunkReady(chunk, ChunkElemsCnt(chunk_num));
     }
     ++size_;
 
-    return &chunk[(size_ - 1) % FULL_CHUNK_SIZE_];
+    return &chunk[GetChunkOffset(size_ - 1)];
   }
 
   void RollBackReservedBack() {
     --size_;
   }
 
+  // Allocates every chunk needed to hold capacity elements.
+  void Reserve(const size_t capacity) {
+    const size_t chunks_cnt = CalcChunksCnt(capacity);
+    if (chunks_cnt > chunks_.Size()) {
+      chunks_.Resize(chunks_cnt);
+    }
+    for (size_t i = CalcChunksCnt(size_); i < chunks_cnt; ++i) {
+      ElemT*& chunk = chunks_.At(i);
+      if (chunk == nullptr) {
+        MakeChunkReady(chunk, 0);
+      }
+    }
+  }
+
+  // Hands the chunks past Size() back to the pool.
   void Shrink() {
-    for (size_t i = GetChunkNum(size_) + 1; i < chunks_.Size(); ++i) {
-      ::operator delete(chunks_.At(i));
-      chunks_.At(i) = nullptr;
+    const size_t used_chunks_cnt = CalcChunksCnt(size_);
+    for (size_t i = used_chunks_cnt; i < chunks_.Size(); ++i) {
+      ReleaseChunk(chunks_.At(i), 0);
     }
+    chunks_.Resize(used_chunks_cnt);
+    chunks_.Shrink();
+  }
+
+  [[nodiscard]] inline Pool& GetPool() {
+    return shared_pool_ != nullptr ? *shared_pool_ : own_pool_;
+  }
+
+  [[nodiscard]] inline const Pool& GetPool() const {
+    return shared_pool_ != nullptr ? *shared_pool_ : own_pool_;
   }
 
  private:
-  bool IsChunkReady(const size_t chunk_index) {
-    return chunks_.At(chunk_index) != nullptr;
+  static constexpr size_t CalcChunksCnt(const size_t size) {
+    return (size + FULL_CHUNK_SIZE_ - 1) / FULL_CHUNK_SIZE_;
   }
 
-  size_t CalcChunksCnt(const size_t size) {
-    return (sizeof(ElemT) * size + CHUNK_CAP_ - 1) / CHUNK_CAP_;
+  static constexpr size_t GetChunkNum(const size_t elem_index) {
+    if constexpr (IS_POWER_OF_TWO_) {
+      return elem_index >> CHUNK_SHIFT_;
+    } else {
+      return elem_index / FULL_CHUNK_SIZE_;
+    }
   }
 
-  size_t GetChunkNum(const size_t elem_index) {
-    return elem_index / FULL_CHUNK_SIZE_;
+  static constexpr size_t GetChunkOffset(const size_t elem_index) {
+    if constexpr (IS_POWER_OF_TWO_) {
+      return elem_index & (FULL_CHUNK_SIZE_ - 1);
+    } else {
+      return elem_index % FULL_CHUNK_SIZE_;
+    }
   }
 
-  size_t GetChunkSize(const size_t chunk_num) {
-    return (chunk_num == chunks_.Size() - 1 || chunks_.Size() == 0) ? size_ % FULL_CHUNK_SIZE_ : FULL_CHUNK_SIZE_;
+  // Number of elements of [0, size_) that fall into chunk chunk_num.
+  size_t ChunkElemsCnt(const size_t chunk_num) const {
+    const size_t first = chunk_num * FULL_CHUNK_SIZE_;
+    return first >= size_ ? 0 : std::min(FULL_CHUNK_SIZE_, size_ - first);
   }
 
-  void DestructChunk(ElemT*& chunk, const size_t chunk_size) {
+  void MakeChunkReady(ElemT*& chunk, const size_t to_construct) {
+    ElemT* new_chunk = static_cast<ElemT*>(GetPool().Acquire());
+    try {
+      Construct(new_chunk, to_construct, value_);
+    } catch (...) {
+      GetPool().Release(new_chunk);
+      throw;
+    }
+    chunk = new_chunk;
+  }
+
+  void ReleaseChunk(ElemT*& chunk, const size_t chunk_size) {
     if (chunk == nullptr) {
       return;
     }
 
     Destruct(chunk, chunk_size);
+    GetPool().Release(chunk);
     chunk = nullptr;
   }
 
-  void DestructAndDeleteChunk(ElemT*& chunk, const size_t chunk_size) {
-    if (chunk == nullptr) {
-      return;
+  void ReleaseAllChunks() {
+    for (size_t i = 0; i < chunks_.Size(); ++i) {
+      ReleaseChunk(chunks_.At(i), ChunkElemsCnt(i));
     }
-
-    DestructAndDelete(chunk, chunk_size);
-    chunk = nullptr;
+    chunks_.Resize(0);
   }
 
-  void MakeChunkReady(ElemT*& chunk, const size_t to_construct) {
-    chunk = static_cast<ElemT*>(::operator new(CHUNK_CAP_));
-    Construct(chunk, to_construct, value_);
+  void SwapFields(ChunkedStorage& other) {
+    std::swap(chunks_, other.chunks_);
+    std::swap(size_, other.size_);
+    std::swap(value_, other.value_);
+    std::swap(shared_pool_, other.shared_pool_);
+    std::swap(own_pool_, other.own_pool_);
   }
 
  private:
-  static const size_t MIN_CHUNK_CAP_ = 1024;
-  static const size_t CHUNK_CAP_ = std::max(MIN_CHUNK_CAP_, sizeof(ElemT) * 8);
-  static const size_t FULL_CHUNK_SIZE_ = CHUNK_CAP_ / sizeof(ElemT);
+  static constexpr bool IS_POWER_OF_TWO_ = std::has_single_bit(FULL_CHUNK_SIZE_);
+  static constexpr size_t CHUNK_SHIFT_ = std::countr_zero(FULL_CHUNK_SIZE_);
 
- private:
   DynamicStorage<ElemT*> chunks_;
 
   size_t size_ = 0;
 
-  ElemT value_;
+  ElemT value_{};
+
+  Pool* shared_pool_{ResourceScope<Pool>::Current()};
+  Pool own_pool_;
 
 };
 
+// Chunks never move with the storage, but value_, the chunk table and the own pool do.
+template<typename ElemT, size_t N, typename Geometry>
+struct IsTriviallyRelocatable<ChunkedStorage<ElemT, N, Geometry>> :
+  std::conjunction<
+    IsTriviallyRelocatable<ElemT>,
+    IsTriviallyRelocatable<DynamicStorage<ElemT*>>,
+    IsTriviallyRelocatable<typename ChunkedStorage<ElemT, N, Geometry>::Pool>
+  > {
+};
+
+template<typename ElemT, size_t N>
+using PowerOfTwoChunkedStorage = ChunkedStorage<ElemT, N, PowerOfTwoChunks<8>>;
+
+template<typename ElemT, size_t N>
+using PageChunkedStorage = ChunkedStorage<ElemT, N, PageChunks<>>;
+
 #endif /* chunked_storage.hpp */
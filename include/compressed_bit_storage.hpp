@@ -0,0 +1,550 @@
+#ifndef COMPRESSED_BIT_STORAGE_HPP
+#define COMPRESSED_BIT_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <initializer_list>
+#include <algorithm>
+
+#include "error_msgs.hpp"
+#include "vector.hpp"
+#include "roaring_container.hpp"
+
+// Marker storage: Vector<bool, CompressedBitStorage> keeps its bits in roaring containers,
+// one per 65536-bit block that has any bit set, instead of one word per 64 bits.
+template<typename ElemT, size_t N = 0>
+class CompressedBitStorage;
+
+template<typename BoolVector>
+class CompressedBitProxy {
+ public:
+  CompressedBitProxy(BoolVector* vector, const size_t index) : vector_{vector}, index_{index} {
+  }
+
+  CompressedBitProxy(const CompressedBitProxy& other_copy) = default;
+
+  operator bool() const {
+    return vector_->Test(index_);
+  }
+
+  CompressedBitProxy& operator=(const bool value) {
+    vector_->Set(index_, value);
+    return *this;
+  }
+
+  CompressedBitProxy& operator=(const CompressedBitProxy& other_copy) {
+    return operator=(static_cast<bool>(other_copy));
+  }
+
+ private:
+  BoolVector* vector_;
+  size_t index_;
+
+};
+
+template<size_t N, typename CheckPolicy>
+class Vector<bool, CompressedBitStorage, N, CheckPolicy> {
+ public:
+  using value_type = bool;
+
+  using pointer = bool*;
+  using const_pointer = const bool*;
+
+  using reference = CompressedBitProxy<Vector>;
+  using const_reference = bool;
+
+  using difference_type = std::ptrdiff_t;
+
+  using iterator_category = std::random_access_iterator_tag;
+
+  using check_policy = CheckPolicy;
+
+  using iterator       = VectorIterator<Vector>;
+  using const_iterator = ConstVectorIterator<Vector>;
+
+  using Word = RoaringContainer::Word;
+
+ public:
+  Vector() = default;
+
+  Vector(const std::initializer_list<bool>& init_list) {
+    for (bool value : init_list) {
+      EmplaceBack(value);
+    }
+  }
+
+  explicit Vector(const size_t size) : size_{size} {
+  }
+
+  Vector(const size_t size, const bool value) : size_{size} {
+    if (value) {
+      FillBits(0, size_, true);
+    }
+  }
+
+  template<template<typename StorageT, size_t StorageSize> class Storage, size_t M, typename OtherPolicy>
+  explicit Vector(const Vector<bool, Storage, M, OtherPolicy>& dense) : size_{dense.Size()} {
+    Word block[RoaringContainer::WORDS_CNT_];
+    for (size_t key = 0; key < KeysCnt(); ++key) {
+      const size_t words_cnt = CopyDenseBlock(dense, key, block);
+      std::fill(block + words_cnt, block + RoaringContainer::WORDS_CNT_, 0);
+
+      RoaringContainer container(key);
+      container.FromWords(block);
+      if (!container.Empty()) {
+        containers_.PushBack(std::move(container));
+      }
+    }
+  }
+
+  Vector(const Vector& other_copy) = default;
+
+  Vector(Vector&& other_move) = default;
+
+  ~Vector() = default;
+
+  Vector& operator=(const Vector& other_copy) = default;
+
+  Vector& operator=(Vector&& other_move) = default;
+
+  inline ConstVectorIterator<Vector> cbegin() const {
+    return ConstVectorIterator<Vector>(this, 0);
+  }
+
+  inline ConstVectorIterator<Vector> cend() const {
+    return ConstVectorIterator<Vector>(this, Size());
+  }
+
+  inline VectorIterator<Vector> begin() {
+    return VectorIterator<Vector>(this, 0);
+  }
+
+  inline ConstVectorIterator<Vector> begin() const {
+    return cbegin();
+  }
+
+  inline VectorIterator<Vector> end() {
+    return VectorIterator<Vector>(this, Size());
+  }
+
+  inline ConstVectorIterator<Vector> end() const {
+    return cend();
+  }
+
+  [[nodiscard]] inline CompressedBitProxy<Vector> At(const size_t index) noexcept {
+    return CompressedBitProxy<Vector>(this, index);
+  }
+
+  [[nodiscard]] inline bool At(const size_t index) const noexcept {
+    return Test(index);
+  }
+
+  [[nodiscard]] inline CompressedBitProxy<Vector> operator[](const size_t index) {
+    CheckIndex(index);
+    return At(index);
+  }
+
+  [[nodiscard]] inline bool operator[](const size_t index) const {
+    CheckIndex(index);
+    return At(index);
+  }
+
+  [[nodiscard]] bool Test(const size_t index) const {
+    const RoaringContainer* container = Find(index >> KEY_SHIFT_);
+    return container != nullptr && container->Contains(index & LOW_MASK_);
+  }
+
+  void Set(const size_t index, const bool value) {
+    if (value) {
+      FindOrInsert(index >> KEY_SHIFT_).Add(index & LOW_MASK_);
+      return;
+    }
+
+    const size_t pos = LowerBound(index >> KEY_SHIFT_);
+    if (pos != containers_.Size() && containers_[pos].Key() == index >> KEY_SHIFT_) {
+      containers_[pos].Remove(index & LOW_MASK_);
+      EraseIfEmpty(pos);
+    }
+  }
+
+  [[nodiscard]] inline size_t Size() const noexcept {
+    return size_;
+  }
+
+  [[nodiscard]] inline bool Front() const {
+    if (size_ == 0) {
+      throw std::logic_error(BAD_FRONT_MSG);
+    }
+
+    return Test(0);
+  }
+
+  [[nodiscard]] inline bool Back() const {
+    if (size_ == 0) {
+      throw std::logic_error(BAD_BACK_MSG);
+    }
+
+    return Test(size_ - 1);
+  }
+
+  void Resize(const size_t new_size) {
+    if (new_size < size_) {
+      FillBits(new_size, size_, false);
+    }
+    size_ = new_size;
+  }
+
+  void EmplaceBack(const bool value) {
+    ++size_;
+    if (value) {
+      Set(size_ - 1, true);
+    }
+  }
+
+  void PushBack(const bool value) {
+    EmplaceBack(value);
+  }
+
+  void PopBack() {
+    if (size_ == 0) {
+      throw std::logic_error(BAD_POP_MSG);
+    }
+
+    Set(size_ - 1, false);
+    --size_;
+  }
+
+  // Re-picks the smallest form for every container and drops spare capacity.
+  void Shrink() {
+    for (size_t i = 0; i < containers_.Size(); ++i) {
+      containers_[i].Optimize();
+    }
+    containers_.Shrink();
+  }
+
+  // Counts the whole container buffer, spare capacity included, and each container's own
+  // buffers.
+  [[nodiscard]] size_t BytesUsed() const {
+    size_t bytes = sizeof(Vector) + containers_.GetStorage().Capacity() * sizeof(RoaringContainer);
+    for (size_t i = 0; i < containers_.Size(); ++i) {
+      bytes += containers_[i].HeapBytes();
+    }
+    return bytes;
+  }
+
+  [[nodiscard]] inline size_t ContainersCnt() const noexcept {
+    return containers_.Size();
+  }
+
+  // Bit queries
+
+  [[nodiscard]] size_t Count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < containers_.Size(); ++i) {
+      count += containers_[i].Cardinality();
+    }
+    return count;
+  }
+
+  [[nodiscard]] bool Any() const {
+    return containers_.Size() != 0;
+  }
+
+  [[nodiscard]] bool None() const {
+    return !Any();
+  }
+
+  [[nodiscard]] bool All() const {
+    return Count() == size_;
+  }
+
+  // Index of the first bit equal to value, or Size() if there is none.
+  [[nodiscard]] size_t FindFirst(const bool value) const {
+    return FindFrom(value, 0);
+  }
+
+  // Index of the first bit after pos equal to value, or Size() if there is none.
+  [[nodiscard]] size_t FindNext(const bool value, const size_t pos) const {
+    return pos + 1 >= size_ ? size_ : FindFrom(value, pos + 1);
+  }
+
+  // Calls func(index) for every set bit in increasing order.
+  template<typename FuncT>
+  void ForEachSetBit(FuncT&& func) const {
+    for (size_t i = 0; i < containers_.Size(); ++i) {
+      const size_t base = containers_[i].Key() << KEY_SHIFT_;
+      containers_[i].ForEach([&func, base](const size_t low) {
+        func(base + low);
+      });
+    }
+  }
+
+  // Bulk operations. Binary ones take a compressed or a dense mask of the same size.
+
+  Vector& SetRange(const size_t first, const size_t last) {
+    CheckRange(first, last);
+    FillBits(first, last, true);
+    return *this;
+  }
+
+  Vector& ClearRange(const size_t first, const size_t last) {
+    CheckRange(first, last);
+    FillBits(first, last, false);
+    return *this;
+  }
+
+  template<typename OtherVector>
+  Vector& And(const OtherVector& other) {
+    *this = Combine<BitOp::AND>(std::move(*this), other);
+    return *this;
+  }
+
+  template<typename OtherVector>
+  Vector& Or(const OtherVector& other) {
+    *this = Combine<BitOp::OR>(std::move(*this), other);
+    return *this;
+  }
+
+  template<typename OtherVector>
+  Vector& Xor(const OtherVector& other) {
+    *this = Combine<BitOp::XOR>(std::move(*this), other);
+    return *this;
+  }
+
+  template<typename OtherVector>
+  Vector& AndNot(const OtherVector& other) {
+    *this = Combine<BitOp::AND_NOT>(std::move(*this), other);
+    return *this;
+  }
+
+  template<typename OtherVector>
+  Vector& operator&=(const OtherVector& other) {
+    return And(other);
+  }
+
+  template<typename OtherVector>
+  Vector& operator|=(const OtherVector& other) {
+    return Or(other);
+  }
+
+  template<typename OtherVector>
+  Vector& operator^=(const OtherVector& other) {
+    return Xor(other);
+  }
+
+  template<typename OtherVector>
+  friend Vector operator&(const Vector& lhs, const OtherVector& rhs) {
+    return Combine<BitOp::AND>(lhs, rhs);
+  }
+
+  template<typename OtherVector>
+  friend Vector operator|(const Vector& lhs, const OtherVector& rhs) {
+    return Combine<BitOp::OR>(lhs, rhs);
+  }
+
+  template<typename OtherVector>
+  friend Vector operator^(const Vector& lhs, const OtherVector& rhs) {
+    return Combine<BitOp::XOR>(lhs, rhs);
+  }
+
+  template<typename OtherVector>
+  friend Vector AndNot(const Vector& lhs, const OtherVector& rhs) {
+    return Combine<BitOp::AND_NOT>(lhs, rhs);
+  }
+
+ private:
+  static constexpr size_t KEY_SHIFT_ = 16;
+  static constexpr size_t LOW_MASK_  = RoaringContainer::BITS_CNT_ - 1;
+
+ private:
+  inline void CheckIndex(const size_t index) const {
+    if constexpr (CheckPolicy::ENABLED) {
+      if (index >= size_) {
+        throw std::out_of_range(BAD_INDEX_MSG);
+      }
+    }
+  }
+
+  void CheckRange(const size_t first, const size_t last) const {
+    if (first > last || last > size_) {
+      throw std::out_of_range(BAD_RANGE_MSG);
+    }
+  }
+
+  inline size_t KeysCnt() const noexcept {
+    return (size_ + LOW_MASK_) >> KEY_SHIFT_;
+  }
+
+  size_t LowerBound(const size_t key) const {
+    size_t first = 0;
+    size_t last = containers_.Size();
+    while (first < last) {
+      const size_t mid = (first + last) / 2;
+      if (containers_[mid].Key() < key) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+    return first;
+  }
+
+  const RoaringContainer* Find(const size_t key) const {
+    const size_t pos = LowerBound(key);
+    return pos != containers_.Size() && containers_[pos].Key() == key ? &containers_[pos] : nullptr;
+  }
+
+  RoaringContainer& FindOrInsert(const size_t key) {
+    const size_t pos = LowerBound(key);
+    if (pos == containers_.Size() || containers_[pos].Key() != key) {
+      const RoaringContainer container(key);
+      containers_.Insert(containers_.cbegin() + pos, &container, &container + 1);
+    }
+    return containers_[pos];
+  }
+
+  void EraseIfEmpty(const size_t pos) {
+    if (containers_[pos].Empty()) {
+      containers_.Erase(containers_.cbegin() + pos, containers_.cbegin() + pos + 1);
+    }
+  }
+
+  size_t FindFrom(const bool value, const size_t first) const {
+    size_t key = first >> KEY_SHIFT_;
+    size_t low = first & LOW_MASK_;
+    size_t pos = LowerBound(key);
+
+    while (key < KeysCnt()) {
+      const bool present = pos != containers_.Size() && containers_[pos].Key() == key;
+      if (value && !present) {
+        if (pos == containers_.Size()) {
+          return size_;
+        }
+        key = containers_[pos].Key();
+        low = 0;
+        continue;
+      }
+      if (!value && !present) {
+        return std::min(size_, (key << KEY_SHIFT_) + low);
+      }
+
+      const size_t found = value ? containers_[pos].NextSet(low) : containers_[pos].NextUnset(low);
+      if (found != RoaringContainer::BITS_CNT_) {
+        return std::min(size_, (key << KEY_SHIFT_) + found);
+      }
+      ++key;
+      ++pos;
+      low = 0;
+    }
+    return size_;
+  }
+
+  void FillBits(const size_t first, const size_t last, const bool value) {
+    for (size_t index = first; index < last;) {
+      const size_t key = index >> KEY_SHIFT_;
+      const size_t block_end = std::min(last, (key + 1) << KEY_SHIFT_);
+
+      if (value) {
+        FindOrInsert(key).FillRange(index & LOW_MASK_, block_end - (key << KEY_SHIFT_), true);
+      } else {
+        const size_t pos = LowerBound(key);
+        if (pos != containers_.Size() && containers_[pos].Key() == key) {
+          containers_[pos].FillRange(index & LOW_MASK_, block_end - (key << KEY_SHIFT_), false);
+          EraseIfEmpty(pos);
+        }
+      }
+      index = block_end;
+    }
+  }
+
+  // Builds lhs Op rhs walking both sorted key lists; a key missing on one side acts as an
+  // empty container. Containers only lhs contributes are moved out of an rvalue lhs.
+  template<BitOp Op, typename LhsT>
+  static Vector Combine(LhsT&& lhs, const Vector& rhs) {
+    if (rhs.size_ != lhs.size_) {
+      throw std::invalid_argument(BAD_SIZE_MISMATCH);
+    }
+
+    Vector result(lhs.size_);
+    size_t lhs_pos = 0;
+    size_t rhs_pos = 0;
+    while (lhs_pos < lhs.containers_.Size() || rhs_pos < rhs.containers_.Size()) {
+      const size_t lhs_key = lhs_pos < lhs.containers_.Size() ? lhs.containers_.At(lhs_pos).Key() : SIZE_MAX;
+      const size_t rhs_key = rhs_pos < rhs.containers_.Size() ? rhs.containers_.At(rhs_pos).Key() : SIZE_MAX;
+
+      if (lhs_key < rhs_key) {
+        if constexpr (Op != BitOp::AND) {
+          result.containers_.PushBack(TakeContainer(std::forward<LhsT>(lhs), lhs_pos));
+        }
+        ++lhs_pos;
+      } else if (rhs_key < lhs_key) {
+        if constexpr (Op == BitOp::OR || Op == BitOp::XOR) {
+          result.containers_.PushBack(rhs.containers_.At(rhs_pos));
+        }
+        ++rhs_pos;
+      } else {
+        result.PushIfNotEmpty(RoaringContainer::Combine<Op>(lhs.containers_.At(lhs_pos++),
+                                                            rhs.containers_.At(rhs_pos++)));
+      }
+    }
+    return result;
+  }
+
+  // AND and AND_NOT only visit blocks present in lhs; OR and XOR visit every dense block.
+  template<BitOp Op, typename LhsT, template<typename StorageT, size_t StorageSize> class Storage,
+           size_t M, typename OtherPolicy>
+  static Vector Combine(LhsT&& lhs, const Vector<bool, Storage, M, OtherPolicy>& dense) {
+    if (dense.Size() != lhs.size_) {
+      throw std::invalid_argument(BAD_SIZE_MISMATCH);
+    }
+
+    Vector result(lhs.size_);
+    Word block[RoaringContainer::WORDS_CNT_];
+    size_t pos = 0;
+    for (size_t key = 0; key < lhs.KeysCnt(); ++key) {
+      const bool present = pos != lhs.containers_.Size() && lhs.containers_.At(pos).Key() == key;
+      if (!present && (Op == BitOp::AND || Op == BitOp::AND_NOT)) {
+        continue;
+      }
+
+      const size_t words_cnt = CopyDenseBlock(dense, key, block);
+      const RoaringContainer absent(key);
+      const RoaringContainer& container = present ? lhs.containers_.At(pos++) : absent;
+      result.PushIfNotEmpty(RoaringContainer::CombineDense<Op>(container, block, words_cnt));
+    }
+    return result;
+  }
+
+  template<typename LhsT>
+  static RoaringContainer TakeContainer(LhsT&& lhs, const size_t pos) {
+    if constexpr (std::is_rvalue_reference_v<LhsT&&>) {
+      return std::move(lhs.containers_.At(pos));
+    } else {
+      return lhs.containers_.At(pos);
+    }
+  }
+
+  void PushIfNotEmpty(RoaringContainer&& container) {
+    if (!container.Empty()) {
+      containers_.PushBack(std::move(container));
+    }
+  }
+
+  template<typename DenseVector>
+  static size_t CopyDenseBlock(const DenseVector& dense, const size_t key, Word* block) {
+    const size_t first_word = key * RoaringContainer::WORDS_CNT_;
+    const size_t words_cnt = std::min(RoaringContainer::WORDS_CNT_, dense.WordsCnt() - first_word);
+    for (size_t i = 0; i < words_cnt; ++i) {
+      block[i] = dense.GetWord(first_word + i);
+    }
+    return words_cnt;
+  }
+
+ private:
+  Vector<RoaringContainer> containers_;
+  size_t size_{0};
+
+};
+
+#endif /* compressed_bit_storage.hpp */
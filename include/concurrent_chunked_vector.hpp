@@ -0,0 +1,322 @@
+#ifndef CONCURRENT_CHUNKED_VECTOR_HPP
+#define CONCURRENT_CHUNKED_VECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "object_helpers.hpp"
+#include "chunk_geometry.hpp"
+
+// An append-only vector many threads can grow at once. As in ChunkedStorage, elements live
+// in fixed-size chunks that never move. Chunk pointers sit in a directory of blocks of
+// doubling size: a block is never reallocated once installed, so a reader holding an index
+// below Size() needs no lock.
+//
+// An append reserves its indices with a fetch_add, installs any missing block and chunk
+// with a compare-exchange (the loser frees its copy), constructs its elements and marks
+// them in the chunk's ready bitmap. It then moves Size() forward over the ready prefix
+// with a compare-exchange, so Size() only ever covers constructed elements and an append
+// never waits for a slower one: whichever append completes the prefix publishes it.
+// That needs everything FindUnready reads to be sequentially consistent: the installs and
+// loads of blocks and chunks and the ready bits. Two appends finishing at once each set
+// their own ready bits, then read the other's chunk pointers and bits. With release and
+// acquire alone both reads may miss, so each append stops at the other and the prefix
+// stays unpublished. In a single total order, whichever append marks its bits last sees
+// everything the other installed and marked before it, and publishes both. On x86 this
+// costs nothing: the read-modify-writes are locked either way and the loads plain.
+// Element constructors must not throw once indices are reserved, and running out of
+// memory there terminates instead of leaving a hole below Size().
+template<typename ElemT, typename Geometry = ByteSizedChunks>
+class ConcurrentChunkedVector {
+ public:
+  static constexpr size_t CHUNK_SIZE_ = Geometry::template CHUNK_SIZE<ElemT>;
+  static constexpr size_t ALIGNMENT_ = std::max(Geometry::ALIGNMENT, alignof(ElemT));
+
+  static_assert(CHUNK_SIZE_ != 0);
+  static_assert(std::is_nothrow_move_constructible_v<ElemT>);
+
+ public:
+  ConcurrentChunkedVector() = default;
+
+  ConcurrentChunkedVector(const ConcurrentChunkedVector&) = delete;
+  ConcurrentChunkedVector& operator=(const ConcurrentChunkedVector&) = delete;
+
+  // No append may be running.
+  ~ConcurrentChunkedVector() {
+    const size_t size = size_.load(std::memory_order_acquire);
+    for (size_t block_num = 0; block_num < BLOCKS_CNT_; ++block_num) {
+      std::atomic<Chunk*>* block = blocks_[block_num].load(std::memory_order_acquire);
+      if (block == nullptr) {
+        continue;
+      }
+      for (size_t i = 0; i < BlockChunksCnt(block_num); ++i) {
+        Chunk* chunk = block[i].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+          continue;
+        }
+        const size_t first = (FirstChunkOf(block_num) + i) * CHUNK_SIZE_;
+        if (first < size) {
+          Destruct(chunk->Elems(), std::min(CHUNK_SIZE_, size - first));
+        }
+        delete chunk;
+      }
+      delete[] block;
+    }
+  }
+
+  // Number of published elements. Every index below it can be read from any thread.
+  [[nodiscard]] inline size_t Size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] inline ElemT& At(const size_t index) {
+    return GetChunk(GetChunkNum(index))->Elems()[GetChunkOffset(index)];
+  }
+
+  [[nodiscard]] inline const ElemT& At(const size_t index) const {
+    return const_cast<ConcurrentChunkedVector*>(this)->At(index);
+  }
+
+  [[nodiscard]] inline ElemT& operator[](const size_t index) {
+    return At(index);
+  }
+
+  [[nodiscard]] inline const ElemT& operator[](const size_t index) const {
+    return At(index);
+  }
+
+  // Returns the index of the new element.
+  template<typename... ArgsT>
+  size_t EmplaceBack(ArgsT&&... args) {
+    if constexpr (std::is_nothrow_constructible_v<ElemT, ArgsT&&...>) {
+      return Append(1, [&args...](ElemT* elem, size_t) noexcept {
+        ConstructOne(elem, std::forward<ArgsT>(args)...);
+      });
+    } else {
+      ElemT tmp(std::forward<ArgsT>(args)...);
+      return Append(1, [&tmp](ElemT* elem, size_t) noexcept {
+        ConstructOne(elem, std::move(tmp));
+      });
+    }
+  }
+
+  size_t PushBack(const ElemT& new_elem) {
+    return EmplaceBack(new_elem);
+  }
+
+  size_t PushBack(ElemT&& new_elem) {
+    return EmplaceBack(std::move(new_elem));
+  }
+
+  // Appends count value-initialized elements and returns the index of the first one.
+  size_t GrowBy(const size_t count) {
+    static_assert(std::is_nothrow_default_constructible_v<ElemT>);
+    return Append(count, [](ElemT* elems, const size_t elems_cnt) noexcept {
+      DefaultConstruct(elems, elems_cnt);
+    });
+  }
+
+  size_t GrowBy(const size_t count, const ElemT& value) {
+    static_assert(std::is_nothrow_copy_constructible_v<ElemT>);
+    return Append(count, [&value](ElemT* elems, const size_t elems_cnt) noexcept {
+      Construct(elems, elems_cnt, value);
+    });
+  }
+
+  // Installs the chunks for the first capacity elements ahead of the appends that need them.
+  void Reserve(const size_t capacity) {
+    for (size_t chunk_num = 0; chunk_num * CHUNK_SIZE_ < capacity; ++chunk_num) {
+      EnsureChunk(chunk_num);
+    }
+  }
+
+  // Calls func(chunk, count) for the published elements, chunk by chunk.
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    const size_t size = Size();
+    for (size_t first = 0; first < size; first += CHUNK_SIZE_) {
+      if (!CallSegment(func, GetChunk(GetChunkNum(first))->Elems(), std::min(CHUNK_SIZE_, size - first))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return const_cast<ConcurrentChunkedVector*>(this)->ForEachSegment([&func](ElemT* chunk, const size_t count) {
+      return CallSegment(func, static_cast<const ElemT*>(chunk), count);
+    });
+  }
+
+ private:
+  // Chunks in directory block 0; block k holds FIRST_BLOCK_CHUNKS_ << k of them.
+  static constexpr size_t FIRST_BLOCK_CHUNKS_ = 64;
+  static constexpr size_t BLOCKS_CNT_ = 40;
+
+  static constexpr size_t READY_WORDS_CNT_ = (CHUNK_SIZE_ + 63) / 64;
+
+  static constexpr bool IS_POWER_OF_TWO_ = std::has_single_bit(CHUNK_SIZE_);
+  static constexpr size_t CHUNK_SHIFT_ = std::countr_zero(CHUNK_SIZE_);
+
+  static constexpr size_t GetChunkNum(const size_t elem_index) {
+    if constexpr (IS_POWER_OF_TWO_) {
+      return elem_index >> CHUNK_SHIFT_;
+    } else {
+      return elem_index / CHUNK_SIZE_;
+    }
+  }
+
+  static constexpr size_t GetChunkOffset(const size_t elem_index) {
+    if constexpr (IS_POWER_OF_TWO_) {
+      return elem_index & (CHUNK_SIZE_ - 1);
+    } else {
+      return elem_index % CHUNK_SIZE_;
+    }
+  }
+
+  static constexpr size_t BlockChunksCnt(const size_t block_num) {
+    return FIRST_BLOCK_CHUNKS_ << block_num;
+  }
+
+  static constexpr size_t FirstChunkOf(const size_t block_num) {
+    return FIRST_BLOCK_CHUNKS_ * ((size_t{1} << block_num) - 1);
+  }
+
+  static constexpr size_t GetBlockNum(const size_t chunk_num) {
+    return std::bit_width(chunk_num / FIRST_BLOCK_CHUNKS_ + 1) - 1;
+  }
+
+  struct Chunk {
+    // Bit i is set once element i has been constructed.
+    std::atomic<uint64_t> ready[READY_WORDS_CNT_]{};
+    alignas(ALIGNMENT_) unsigned char raw_elems[CHUNK_SIZE_ * sizeof(ElemT)];
+
+    inline ElemT* Elems() {
+      return reinterpret_cast<ElemT*>(raw_elems);
+    }
+  };
+
+  // The chunk must have been installed, which holds for every index below Size().
+  Chunk* GetChunk(const size_t chunk_num) {
+    const size_t block_num = GetBlockNum(chunk_num);
+    std::atomic<Chunk*>* block = blocks_[block_num].load(std::memory_order_acquire);
+    assert(block != nullptr);
+    return block[chunk_num - FirstChunkOf(block_num)].load(std::memory_order_acquire);
+  }
+
+  // Null if the block or the chunk has not been installed yet.
+  Chunk* FindChunk(const size_t chunk_num) {
+    const size_t block_num = GetBlockNum(chunk_num);
+    std::atomic<Chunk*>* block = blocks_[block_num].load(std::memory_order_seq_cst);
+    return block == nullptr ? nullptr : block[chunk_num - FirstChunkOf(block_num)].load(std::memory_order_seq_cst);
+  }
+
+  std::atomic<Chunk*>& EnsureSlot(const size_t chunk_num) {
+    const size_t block_num = GetBlockNum(chunk_num);
+    assert(block_num < BLOCKS_CNT_);
+
+    std::atomic<Chunk*>* block = blocks_[block_num].load(std::memory_order_acquire);
+    if (block == nullptr) {
+      std::atomic<Chunk*>* new_block = new std::atomic<Chunk*>[BlockChunksCnt(block_num)]();
+      if (blocks_[block_num].compare_exchange_strong(block, new_block, std::memory_order_seq_cst)) {
+        block = new_block;
+      } else {
+        delete[] new_block;
+      }
+    }
+    return block[chunk_num - FirstChunkOf(block_num)];
+  }
+
+  Chunk* EnsureChunk(const size_t chunk_num) {
+    std::atomic<Chunk*>& slot = EnsureSlot(chunk_num);
+    Chunk* chunk = slot.load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      Chunk* new_chunk = new Chunk;
+      if (slot.compare_exchange_strong(chunk, new_chunk, std::memory_order_seq_cst)) {
+        chunk = new_chunk;
+      } else {
+        delete new_chunk;
+      }
+    }
+    return chunk;
+  }
+
+  // Sets the ready bits of [first, last), which lie in one chunk.
+  static void MarkReady(Chunk* chunk, const size_t first, const size_t last) {
+    for (size_t bit = first; bit < last;) {
+      const size_t word_end = std::min(last, (bit / 64 + 1) * 64);
+      const uint64_t high = word_end % 64 == 0 ? ~uint64_t{0} : (uint64_t{1} << (word_end % 64)) - 1;
+      chunk->ready[bit / 64].fetch_or(high & (~uint64_t{0} << (bit % 64)), std::memory_order_seq_cst);
+      bit = word_end;
+    }
+  }
+
+  // First index at or after from whose element is not ready.
+  size_t FindUnready(size_t from) {
+    while (true) {
+      Chunk* chunk = FindChunk(GetChunkNum(from));
+      if (chunk == nullptr) {
+        return from;
+      }
+      for (size_t offset = GetChunkOffset(from); offset < CHUNK_SIZE_;) {
+        const size_t word_left = std::min(64 - offset % 64, CHUNK_SIZE_ - offset);
+        const uint64_t unready = ~chunk->ready[offset / 64].load(std::memory_order_seq_cst) >> (offset % 64);
+        const size_t ready_cnt = std::min<size_t>(std::countr_zero(unready), word_left);
+        from += ready_cnt;
+        if (ready_cnt < word_left) {
+          return from;
+        }
+        offset += ready_cnt;
+      }
+    }
+  }
+
+  // Reserves count indices, calls construct(elems, elems_cnt) chunk by chunk over them,
+  // marks them ready and publishes as much of the ready prefix as it can.
+  template<typename ConstructT>
+  size_t Append(const size_t count, ConstructT&& construct) noexcept {
+    const size_t first = reserved_.fetch_add(count, std::memory_order_relaxed);
+    const size_t last = first + count;
+
+    for (size_t index = first; index < last;) {
+      const size_t chunk_end = std::min(last, (GetChunkNum(index) + 1) * CHUNK_SIZE_);
+      Chunk* chunk = EnsureChunk(GetChunkNum(index));
+      construct(chunk->Elems() + GetChunkOffset(index), chunk_end - index);
+      MarkReady(chunk, GetChunkOffset(index), GetChunkOffset(index) + chunk_end - index);
+      index = chunk_end;
+    }
+
+    Publish();
+    return first;
+  }
+
+  // An append that finds an earlier one still unready stops there; that one publishes
+  // past both once it finishes.
+  void Publish() noexcept {
+    size_t published = size_.load(std::memory_order_acquire);
+    while (true) {
+      const size_t ready_end = FindUnready(published);
+      if (ready_end == published ||
+          size_.compare_exchange_weak(published, ready_end, std::memory_order_acq_rel)) {
+        return;
+      }
+    }
+  }
+
+ private:
+  std::atomic<std::atomic<Chunk*>*> blocks_[BLOCKS_CNT_]{};
+
+  alignas(64) std::atomic<size_t> reserved_{0};
+  alignas(64) std::atomic<size_t> size_{0};
+
+};
+
+#endif /* concurrent_chunked_vector.hpp */
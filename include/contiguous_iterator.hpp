@@ -0,0 +1,170 @@
+#ifndef CONTIGUOUS_ITERATOR_HPP
+#define CONTIGUOUS_ITERATOR_HPP
+
+#include <cstddef>
+#include <compare>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "check_policies.hpp"
+
+// A raw pointer into a contiguous buffer. With checks enabled it also keeps the buffer's bounds
+// and throws like BaseVectorIterator does; without them it is as cheap as the pointer itself.
+template<typename ElemT, typename CheckPolicy>
+class ContiguousIterator {
+ public:
+  friend class ContiguousIterator<const ElemT, CheckPolicy>;
+
+ public:
+  using iterator_concept  = std::contiguous_iterator_tag;
+  using iterator_category = std::random_access_iterator_tag;
+
+  using value_type      = std::remove_const_t<ElemT>;
+  using pointer         = ElemT*;
+  using reference       = ElemT&;
+  using difference_type = std::ptrdiff_t;
+
+ public:
+  ContiguousIterator() = default;
+
+  ContiguousIterator(ElemT* ptr, ElemT* first, ElemT* last) : ptr_{ptr} {
+    if constexpr (CheckPolicy::ENABLED) {
+      range_.first = first;
+      range_.last = last;
+    }
+  }
+
+  template<typename OtherElemT>
+    requires std::is_same_v<const OtherElemT, ElemT> && (!std::is_const_v<OtherElemT>)
+  ContiguousIterator(const ContiguousIterator<OtherElemT, CheckPolicy>& other_copy) :
+    ptr_{other_copy.ptr_} {
+    if constexpr (CheckPolicy::ENABLED) {
+      range_.first = other_copy.range_.first;
+      range_.last = other_copy.range_.last;
+    }
+  }
+
+  inline ContiguousIterator& operator+=(const difference_type diff) {
+    CheckValid(ptr_ + diff);
+
+    ptr_ += diff;
+    return *this;
+  }
+
+  inline ContiguousIterator& operator-=(const difference_type diff) {
+    return this->operator+=(-diff);
+  }
+
+  inline ContiguousIterator& operator++() {
+    return this->operator+=(1);
+  }
+
+  inline ContiguousIterator& operator--() {
+    return this->operator-=(1);
+  }
+
+  inline ContiguousIterator operator++(int) {
+    ContiguousIterator old(*this);
+    this->operator++();
+    return old;
+  }
+
+  inline ContiguousIterator operator--(int) {
+    ContiguousIterator old(*this);
+    this->operator--();
+    return old;
+  }
+
+  inline reference operator[](const difference_type offset) const {
+    CheckOverflow(ptr_ + offset);
+    return ptr_[offset];
+  }
+
+  inline ContiguousIterator operator+(const difference_type diff) const {
+    ContiguousIterator result(*this);
+    result += diff;
+    return result;
+  }
+
+  friend inline ContiguousIterator operator+(const difference_type diff, const ContiguousIterator& it) {
+    return it + diff;
+  }
+
+  inline ContiguousIterator operator-(const difference_type diff) const {
+    return operator+(-diff);
+  }
+
+  inline difference_type operator-(const ContiguousIterator& rhs) const {
+    CheckSameRange(rhs);
+
+    return ptr_ - rhs.ptr_;
+  }
+
+  inline reference operator*() const {
+    CheckOverflow(ptr_);
+
+    return *ptr_;
+  }
+
+  inline pointer operator->() const {
+    return ptr_;
+  }
+
+  inline bool operator==(const ContiguousIterator& rhs) const {
+    CheckSameRange(rhs);
+
+    return ptr_ == rhs.ptr_;
+  }
+
+  inline std::strong_ordering operator<=>(const ContiguousIterator& rhs) const {
+    CheckSameRange(rhs);
+
+    return ptr_ <=> rhs.ptr_;
+  }
+
+ private:
+  static constexpr const char* const OUT_OF_RANGE_MSG_      = "iterator is out of range";
+  static constexpr const char* const INVALID_ITERATOR_MSG_  = "iterator is invalid";
+  static constexpr const char* const DIFFERENT_VECTORS_MSG_ = "iterators of different vectors";
+
+ private:
+  inline void CheckValid(const ElemT* ptr) const {
+    if constexpr (CheckPolicy::ENABLED) {
+      if (ptr + 1 < range_.first || ptr > range_.last) {
+        throw std::logic_error(INVALID_ITERATOR_MSG_);
+      }
+    }
+  }
+
+  inline void CheckOverflow(const ElemT* ptr) const {
+    if constexpr (CheckPolicy::ENABLED) {
+      if (ptr < range_.first || ptr >= range_.last) {
+        throw std::out_of_range(OUT_OF_RANGE_MSG_);
+      }
+    }
+  }
+
+  inline void CheckSameRange(const ContiguousIterator& other) const {
+    if constexpr (CheckPolicy::ENABLED) {
+      if (range_.first != other.range_.first) {
+        throw std::logic_error(DIFFERENT_VECTORS_MSG_);
+      }
+    }
+  }
+
+ private:
+  struct Range {
+    ElemT* first{nullptr};
+    ElemT* last{nullptr};
+  };
+
+  struct NoRange {
+  };
+
+ private:
+  ElemT* ptr_{nullptr};
+  [[no_unique_address]] std::conditional_t<CheckPolicy::ENABLED, Range, NoRange> range_;
+
+};
+
+#endif /* contiguous_iterator.hpp */
@@ -0,0 +1,36 @@
+#ifndef CPU_FEATURES_HPP
+#define CPU_FEATURES_HPP
+
+// Instruction sets detected once at runtime, used to pick SIMD kernels.
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VECTOR_X86_SIMD 1
+#else
+#define VECTOR_X86_SIMD 0
+#endif
+
+struct CpuFeatures {
+  bool sse2{false};
+  bool popcnt{false};
+  bool avx2{false};
+
+  static const CpuFeatures& Get() {
+    static const CpuFeatures features = Detect();
+    return features;
+  }
+
+ private:
+  static CpuFeatures Detect() {
+    CpuFeatures features;
+#if VECTOR_X86_SIMD
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2");
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return features;
+  }
+
+};
+
+#endif /* cpu_features.hpp */
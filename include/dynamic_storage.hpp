@@ -7,37 +7,55 @@
 #include <utility>
 #include <cstdint>
 #include <new>
+#include <memory>
+#include <concepts>
 #include <algorithm>
+#include <type_traits>
 #include <iostream>
 #include "object_helpers.hpp"
 #include "error_msgs.hpp"
+#include "growth_policies.hpp"
+
+template<typename AllocatorT>
+concept HasAllocateZeroed = requires(AllocatorT& allocator, const size_t n) {
+  { allocator.allocate_zeroed(n) } -> std::same_as<typename AllocatorT::value_type*>;
+};
 
 template<
   typename ElemT,
-  template<typename T_> class Allocator,
-  size_t N = 0
+  size_t N = 0,
+  template<typename T_> class Allocator = std::allocator,
+  typename GrowthPolicy = Growth2x
 >
 class DynamicStorage {
  public:
   DynamicStorage() :
-    buffer_{static_cast<ElemT*>(allocator_.allocate(DEFAULT_CAPACITY))},
+    buffer_{allocator_.allocate(DEFAULT_CAPACITY)},
     capacity_{DEFAULT_CAPACITY} {
   }
 
-  DynamicStorage(const size_t size) : 
-    buffer_{static_cast<ElemT*>(allocator_.allocate(size))},
-    capacity_{size},
-    size_{DefaultConstruct(buffer_, size)} {
+  // Elements whose value-initialization is zero-filling come from allocate_zeroed when the
+  // allocator has it, so a large buffer gets lazily zeroed pages instead of a memset.
+  DynamicStorage(const size_t size) {
+    if constexpr (std::is_trivially_default_constructible_v<ElemT> && HasAllocateZeroed<Allocator<ElemT>>) {
+      buffer_ = allocator_.allocate_zeroed(size);
+      size_ = size;
+    } else {
+      buffer_ = allocator_.allocate(size);
+      size_ = DefaultConstruct(buffer_, size);
+    }
+    capacity_ = size;
   }
 
   DynamicStorage(const size_t size, const ElemT& value) :
-    buffer_{static_cast<ElemT*>(allocater_.allocate(size))},
+    buffer_{allocator_.allocate(size)},
     capacity_{size},
     size_{Construct(buffer_, size, value)} {
   }
 
   DynamicStorage(const DynamicStorage& other_copy) :
-    buffer_{SafeCopy(other_copy.buffer_, other_copy.size_, other_copy.size_)},
+    allocator_{other_copy.allocator_},
+    buffer_{SafeCopy(allocator_, other_copy.buffer_, other_copy.size_, other_copy.size_)},
     capacity_(other_copy.size_), size_{other_copy.size_} {
   }
 
@@ -47,10 +65,10 @@ class DynamicStorage {
 
   ~DynamicStorage() {
     if (buffer_ != nullptr) {
-      DestructAndDelete(buffer_, size_);
+      DestructAndDelete(allocator_, buffer_, size_, capacity_);
     }
 
-    size_ = 0;allocator
+    size_ = 0;
     capacity_ = 0;
   }
 
@@ -90,32 +108,21 @@ class DynamicStorage {
   }
 
   void Resize(const size_t new_size) {
-    if (size_ == new_size) {
-      return;
-    }
-
-    if (new_size <= capacity_) {
-      if (new_size < size_) {
-        Destruct(buffer_, newallocator_size, size_);
-      } else {
-        while (size_ < new_size) {
-          DefaultConstruct(buffer_ + size_);
-          ++size_;
-        }
-      }
-    } else if (size_ == capacity_ && new_size == size_ + 1) {
-      DoubleBuffer();
-      DefaultConstruct(buffer_ + size_);
-    } else {
-      IncreaseBuffer(new_size);
-    }
+    ResizeWith(new_size, [](ElemT* buffer, const size_t first, const size_t last) {
+      return DefaultConstruct(buffer, first, last);
+    });
+  }
 
-    size_ = new_size;
+  // Like Resize, but new elements are default-initialized, so trivial ones are not zeroed.
+  void ResizeDefaultInit(const size_t new_size) {
+    ResizeWith(new_size, [](ElemT* buffer, const size_t first, const size_t last) {
+      return DefaultInit(buffer, first, last);
+    });
   }
 
   ElemT* ReserveBack() {
     if (size_ == capacity_) {
-      DoubleBuffer();
+      GrowBuffer();
     }
     ++size_;
     return &buffer_[size_ - 1];
@@ -125,21 +132,42 @@ class DynamicStorage {
     --size_;
   }
 
+  void Reserve(const size_t capacity) {
+    if (capacity > capacity_) {
+      Reallocate(capacity);
+    }
+  }
+
+  // Makes room for count elements at the back with at most one reallocation
+  // and returns the first of them, left unconstructed.
+  ElemT* ReserveBack(const size_t count) {
+    if (size_ + count > capacity_) {
+      Reallocate(std::max(size_ + count, GrowthPolicy::NextCapacity(size_, sizeof(ElemT))));
+    }
+    size_ += count;
+    return buffer_ + size_ - count;
+  }
+
+  void RollBackReservedBack(const size_t count) {
+    size_ -= count;
+  }
+
   void Shrink() {
     if (capacity_ == size_) {
       return;
     }
 
-    ElemT* old_buffer_ = buffer_;
+    ElemT* old_buffer = buffer_;
+    const size_t old_capacity = capacity_;
     if (size_ == 0) {
-      buffer_ = static_cast<ElemT*>(::operator new(DEFAULT_CAPACITY * sizeof(ElemT)));
+      buffer_ = allocator_.allocate(DEFAULT_CAPACITY);
       capacity_ = DEFAULT_CAPACITY;
     } else {
-      buffer_ = SafeMove(old_buffer_, size_, size_);
+      buffer_ = Relocate(allocator_, old_buffer, size_, size_);
       capacity_ = size_;
     }
 
-    DestructAndDelete(old_buffer_, size_);
+    Deallocate(old_buffer, old_capacity);
   }
 
   [[nodiscard]] inline ElemT* Buffer() {
@@ -150,43 +178,97 @@ class DynamicStorage {
     return buffer_;
   }
 
-  void DoubleBuffer() {
-    ElemT* old_buffer = buffer_;
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    return size_ == 0 || CallSegment(func, buffer_, size_);
+  }
 
-    const size_t new_capacity = 2 * size_ + 1;
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return size_ == 0 || CallSegment(func, static_cast<const ElemT*>(buffer_), size_);
+  }
 
-    buffer_ = SafeMove(old_buffer, new_capacity, size_);
-    DestructAndDelete(old_buffer, size_);
-    capacity_ = new_capacity;
+  [[nodiscard]] inline const Allocator<ElemT>& GetAllocator() const {
+    return allocator_;
   }
 
-  void IncreaseBuffer(const size_t new_size) {
-    assert(new_size > capacity_);
-    assert(new_size > size_);
+  void GrowBuffer() {
+    Reallocate(GrowthPolicy::NextCapacity(size_, sizeof(ElemT)));
+  }
+
+  template<typename ConstructT>
+  void ResizeWith(const size_t new_size, ConstructT&& construct) {
+    if (size_ == new_size) {
+      return;
+    }
+
+    if (new_size < size_) {
+      Destruct(buffer_, new_size, size_);
+      size_ = new_size;
+      return;
+    }
+
+    if (new_size > capacity_) {
+      if (size_ == capacity_ && new_size == size_ + 1) {
+        GrowBuffer();
+      } else {
+        Reallocate(new_size);
+      }
+    }
+    size_ = construct(buffer_, size_, new_size);
+  }
+
+  void Reallocate(const size_t new_capacity) {
+    assert(new_capacity >= size_);
 
     ElemT* old_buffer = buffer_;
-    buffer_ = SafeMove(old_buffer, new_size, size_);
-    DefaultConstruct(buffer_, size_, new_size);
-    DestructAndDelete(old_buffer, size_);
-    capacity_ = new_size;
+    buffer_ = Relocate(allocator_, old_buffer, new_capacity, size_);
+    Deallocate(old_buffer, capacity_);
+    capacity_ = new_capacity;
   }
 
  public:
   void SwapFields(DynamicStorage& other) {
+    std::swap(allocator_, other.allocator_);
     std::swap(buffer_, other.buffer_);
     std::swap(size_, other.size_);
     std::swap(capacity_, other.capacity_);
   }
 
+  void Deallocate(ElemT* buffer, const size_t capacity) {
+    if (buffer != nullptr) {
+      allocator_.deallocate(buffer, capacity);
+    }
+  }
+
   static const size_t DEFAULT_CAPACITY = 8;
 
+  Allocator<ElemT> allocator_;
+
   ElemT* buffer_{nullptr};
 
   size_t capacity_{0};
   size_t size_{0};
 
-  Allocator<ElemT> allocator_;
+};
 
+// The buffer lives on the heap, so only the allocator can tie a DynamicStorage to its
+// address. A stateless one, such as std::allocator, never does, whatever its constructors.
+template<typename ElemT, size_t N, template<typename T_> class Allocator, typename GrowthPolicy>
+struct IsTriviallyRelocatable<DynamicStorage<ElemT, N, Allocator, GrowthPolicy>> :
+  std::disjunction<std::is_empty<Allocator<ElemT>>, IsTriviallyRelocatable<Allocator<ElemT>>> {
 };
 
+// DynamicStorage with a non-default growth policy, in the Storage<ElemT, N> shape Vector expects:
+// Vector<int, HalfGrowthStorage>
+
+template<typename ElemT, size_t N>
+using HalfGrowthStorage = DynamicStorage<ElemT, N, std::allocator, Growth1_5x>;
+
+template<typename ElemT, size_t N>
+using SizeClassStorage = DynamicStorage<ElemT, N, std::allocator, SizeClassGrowth<>>;
+
+template<typename ElemT, size_t N>
+using PageRoundedStorage = DynamicStorage<ElemT, N, std::allocator, PageGrowth<>>;
+
 #endif /* dynamic_storage.hpp */
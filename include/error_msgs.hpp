@@ -7,5 +7,13 @@ static const char* const BAD_FRONT_MSG = "attempt to access front element of an
 static const char* const BAD_INDEX_MSG = "attempt to access on vector with invalid index";
 static const char* const BAD_STATIC_OVRFLW = "attempt to use more static memory that we have";
 static const char* const BAD_PUSH_BACK = "no memory to push back new element";
+static const char* const BAD_SIZE_MISMATCH = "attempt to combine vectors of different sizes";
+static const char* const BAD_EMPTY_REDUCE_MSG = "attempt to reduce an empty vector";
+static const char* const BAD_RANGE_MSG = "attempt to access on vector with invalid range";
+static const char* const BAD_MMAP_HEADER_MSG = "mapped file does not hold a vector of this element type";
+static const char* const BAD_SHARED_WRITE_MSG = "attempt to grow a shared vector attached for reading";
+static const char* const BAD_SERIALIZED_MSG = "buffer does not hold a serialized vector of this type";
+static const char* const BAD_SERIALIZED_SIZE_MSG = "serialized vector ends before its last element";
+static const char* const BAD_SERIALIZED_ALIGN_MSG = "serialized vector buffer is misaligned for its elements";
 
 #endif /* error_msgs.hpp */
@@ -0,0 +1,60 @@
+#ifndef GROWTH_POLICIES_HPP
+#define GROWTH_POLICIES_HPP
+
+#include <cstddef>
+#include <algorithm>
+
+// Every policy maps the current size of a full buffer to the capacity of the next one.
+// The returned capacity is always greater than size.
+
+template<size_t Numerator, size_t Denominator>
+struct GeometricGrowth {
+  static_assert(Numerator > Denominator);
+
+  [[nodiscard]] static constexpr size_t NextCapacity(const size_t size, const size_t /*elem_size*/) {
+    return size * Numerator / Denominator + 1;
+  }
+};
+
+using Growth2x   = GeometricGrowth<2, 1>;
+using Growth1_5x = GeometricGrowth<3, 2>;
+
+// Rounds the byte size proposed by BaseGrowth up to the next malloc size class:
+// 16-byte steps up to 128 bytes, then four classes per power of two.
+template<typename BaseGrowth = Growth2x>
+struct SizeClassGrowth {
+  [[nodiscard]] static constexpr size_t NextCapacity(const size_t size, const size_t elem_size) {
+    const size_t bytes = RoundToSizeClass(BaseGrowth::NextCapacity(size, elem_size) * elem_size);
+    return std::max(bytes / elem_size, size + 1);
+  }
+
+  [[nodiscard]] static constexpr size_t RoundToSizeClass(const size_t bytes) {
+    if (bytes <= SMALL_CLASSES_LIMIT_) {
+      return (bytes + SMALL_CLASS_STEP_ - 1) / SMALL_CLASS_STEP_ * SMALL_CLASS_STEP_;
+    }
+
+    size_t power = SMALL_CLASSES_LIMIT_;
+    while (power * 2 < bytes) {
+      power *= 2;
+    }
+    const size_t step = power / CLASSES_PER_POWER_;
+    return (bytes + step - 1) / step * step;
+  }
+
+ private:
+  static const size_t SMALL_CLASSES_LIMIT_ = 128;
+  static const size_t SMALL_CLASS_STEP_    = 16;
+  static const size_t CLASSES_PER_POWER_   = 4;
+};
+
+// Rounds the byte size proposed by BaseGrowth up to a whole number of pages.
+template<typename BaseGrowth = Growth2x, size_t PageSize = 4096>
+struct PageGrowth {
+  [[nodiscard]] static constexpr size_t NextCapacity(const size_t size, const size_t elem_size) {
+    const size_t bytes = BaseGrowth::NextCapacity(size, elem_size) * elem_size;
+    const size_t rounded = (bytes + PageSize - 1) / PageSize * PageSize;
+    return std::max(rounded / elem_size, size + 1);
+  }
+};
+
+#endif /* growth_policies.hpp */
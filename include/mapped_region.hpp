@@ -0,0 +1,195 @@
+#ifndef MAPPED_REGION_HPP
+#define MAPPED_REGION_HPP
+
+#include <cstddef>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Thin RAII wrappers over POSIX file descriptors and shared mappings, for the storages
+// that keep their elements outside the heap. Failed system calls throw std::system_error.
+
+[[noreturn]] inline void ThrowErrno(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+inline size_t PageSize() {
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+inline size_t RoundUpToPages(const size_t bytes) {
+  return (bytes + PageSize() - 1) / PageSize() * PageSize();
+}
+
+class FileDescriptor {
+ public:
+  FileDescriptor() = default;
+
+  explicit FileDescriptor(const int fd) : fd_{fd} {
+  }
+
+  FileDescriptor(const FileDescriptor&) = delete;
+  FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+  FileDescriptor(FileDescriptor&& other_move) : fd_{std::exchange(other_move.fd_, -1)} {
+  }
+
+  FileDescriptor& operator=(FileDescriptor&& other_move) {
+    std::swap(fd_, other_move.fd_);
+    return *this;
+  }
+
+  ~FileDescriptor() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  [[nodiscard]] inline int Get() const {
+    return fd_;
+  }
+
+  [[nodiscard]] inline bool IsOpen() const {
+    return fd_ >= 0;
+  }
+
+  [[nodiscard]] size_t FileBytes() const {
+    struct stat info;
+    if (fstat(fd_, &info) != 0) {
+      ThrowErrno("fstat");
+    }
+    return static_cast<size_t>(info.st_size);
+  }
+
+  void Truncate(const size_t bytes) const {
+    if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+      ThrowErrno("ftruncate");
+    }
+  }
+
+ private:
+  int fd_{-1};
+
+};
+
+// One MAP_SHARED mapping of a whole file, or of anonymous memory when there is no file.
+// Resize keeps the file length and the mapping in step; the mapping may move.
+class MappedRegion {
+ public:
+  MappedRegion() = default;
+
+  // Maps the first bytes of file, which must already be at least that long.
+  MappedRegion(FileDescriptor file, const size_t bytes, const bool writable = true) :
+    file_{std::move(file)}, writable_{writable} {
+    Map(bytes, file_.Get());
+  }
+
+  // Zero-filled memory that belongs to this process only.
+  explicit MappedRegion(const size_t bytes) {
+    Map(bytes, -1);
+  }
+
+  MappedRegion(const MappedRegion&) = delete;
+  MappedRegion& operator=(const MappedRegion&) = delete;
+
+  MappedRegion(MappedRegion&& other_move) {
+    SwapFields(other_move);
+  }
+
+  MappedRegion& operator=(MappedRegion&& other_move) {
+    SwapFields(other_move);
+    return *this;
+  }
+
+  ~MappedRegion() {
+    if (data_ != nullptr) {
+      munmap(data_, bytes_);
+    }
+  }
+
+  [[nodiscard]] inline void* Data() const {
+    return data_;
+  }
+
+  [[nodiscard]] inline size_t Bytes() const {
+    return bytes_;
+  }
+
+  [[nodiscard]] inline const FileDescriptor& File() const {
+    return file_;
+  }
+
+  // Grows the file before the mapping and shrinks it after, so no mapped page ever lies
+  // past the end of the file.
+  void Resize(const size_t bytes) {
+    const size_t old_bytes = bytes_;
+    if (bytes > old_bytes && file_.IsOpen()) {
+      file_.Truncate(bytes);
+    }
+    Remap(bytes);
+    if (bytes < old_bytes && file_.IsOpen()) {
+      file_.Truncate(bytes);
+    }
+  }
+
+  // Follows a file someone else has resized; the file itself is left alone.
+  void Remap(const size_t bytes) {
+    void* data = mremap(data_, bytes_, bytes, MREMAP_MAYMOVE);
+    if (data == MAP_FAILED) {
+      ThrowErrno("mremap");
+    }
+    data_ = data;
+    bytes_ = bytes;
+  }
+
+  void Sync(const bool async = false) const {
+    if (msync(data_, bytes_, async ? MS_ASYNC : MS_SYNC) != 0) {
+      ThrowErrno("msync");
+    }
+  }
+
+  // Advice is only a hint, but MADV_DONTNEED zeroes private anonymous memory, so it is
+  // skipped there instead of discarding the contents.
+  void Advise(const int advice) const {
+    if (advice == MADV_DONTNEED && !file_.IsOpen()) {
+      return;
+    }
+    if (madvise(data_, bytes_, advice) != 0) {
+      ThrowErrno("madvise");
+    }
+  }
+
+ private:
+  void Map(const size_t bytes, const int fd) {
+    const int protection = writable_ ? PROT_READ | PROT_WRITE : PROT_READ;
+    const int flags = fd >= 0 ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+    void* data = mmap(nullptr, bytes, protection, flags, fd, 0);
+    if (data == MAP_FAILED) {
+      ThrowErrno("mmap");
+    }
+    data_ = data;
+    bytes_ = bytes;
+  }
+
+  void SwapFields(MappedRegion& other) {
+    std::swap(file_, other.file_);
+    std::swap(data_, other.data_);
+    std::swap(bytes_, other.bytes_);
+    std::swap(writable_, other.writable_);
+  }
+
+ private:
+  FileDescriptor file_;
+  void* data_{nullptr};
+  size_t bytes_{0};
+  bool writable_{true};
+
+};
+
+#endif /* mapped_region.hpp */
@@ -0,0 +1,262 @@
+#ifndef MMAP_STORAGE_HPP
+#define MMAP_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include "mapped_region.hpp"
+#include "object_helpers.hpp"
+#include "error_msgs.hpp"
+
+enum class MmapAdvice : int {
+  Normal = MADV_NORMAL,
+  Sequential = MADV_SEQUENTIAL,
+  Random = MADV_RANDOM,
+  WillNeed = MADV_WILLNEED,
+  DontNeed = MADV_DONTNEED
+};
+
+// First bytes of every mapping; the elements follow it, so a file written by one process
+// is used by the next one as it is, once the header matches the element type.
+struct MmapHeader {
+  static constexpr uint64_t MAGIC = 0x31504d4d43455656ull; // "VVECMMP1"
+  static constexpr uint32_t VERSION = 1;
+
+  uint64_t magic;
+  uint32_t version;
+  uint32_t elem_size;
+  uint32_t elem_align;
+  uint32_t reserved;
+  uint64_t size;
+};
+
+// Keeps trivially copyable elements in one shared mapping of a file, or of anonymous memory
+// when constructed without a path. Growth extends the file and remaps it, doubling the
+// mapped bytes, and never copies elements; the capacity is whatever fits in the file.
+// Vector<Record, MmapStorage> records(IN_PLACE_STORAGE, "records.bin");
+template<typename ElemT, size_t N = 0>
+class MmapStorage {
+  static_assert(std::is_trivially_copyable_v<ElemT>, "MmapStorage keeps elements as raw bytes");
+  static_assert(alignof(ElemT) <= 4096, "MmapStorage elements must fit the page alignment");
+
+ public:
+  static constexpr size_t HEADER_BYTES_ = (sizeof(MmapHeader) + alignof(ElemT) - 1) / alignof(ElemT) * alignof(ElemT);
+
+ public:
+  MmapStorage() : region_(PageSize()) {
+    InitHeader();
+  }
+
+  MmapStorage(const size_t size) : region_(BytesFor(size)) {
+    InitHeader();
+    if constexpr (!std::is_trivially_default_constructible_v<ElemT>) {
+      std::uninitialized_value_construct_n(buffer_, size);
+    }
+    header_->size = size;
+  }
+
+  MmapStorage(const size_t size, const ElemT& value) : region_(BytesFor(size)) {
+    InitHeader();
+    std::uninitialized_fill_n(buffer_, size, value);
+    header_->size = size;
+  }
+
+  // Opens the file at path, creating it when it does not exist. An existing file is mapped
+  // as it is: only its header is checked, and the elements are not read until touched.
+  explicit MmapStorage(const char* path, const MmapAdvice advice = MmapAdvice::Normal) {
+    FileDescriptor file(open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644));
+    if (!file.IsOpen()) {
+      ThrowErrno(path);
+    }
+
+    const size_t file_bytes = file.FileBytes();
+    if (file_bytes == 0) {
+      file.Truncate(PageSize());
+      region_ = MappedRegion(std::move(file), PageSize());
+      InitHeader();
+    } else {
+      if (file_bytes < HEADER_BYTES_) {
+        throw std::runtime_error(BAD_MMAP_HEADER_MSG);
+      }
+      region_ = MappedRegion(std::move(file), file_bytes);
+      UpdatePointers();
+      CheckHeader();
+    }
+    Advise(advice);
+  }
+
+  MmapStorage(const MmapStorage&) = delete;
+  MmapStorage& operator=(const MmapStorage&) = delete;
+
+  MmapStorage(MmapStorage&& other_move) {
+    this->SwapFields(other_move);
+  }
+
+  MmapStorage& operator=(MmapStorage&& other_move) {
+    this->SwapFields(other_move);
+    return *this;
+  }
+
+  ~MmapStorage() = default;
+
+  [[nodiscard]] inline size_t Size() const {
+    return header_ != nullptr ? header_->size : 0;
+  }
+
+  [[nodiscard]] inline size_t Capacity() const {
+    return header_ != nullptr ? (region_.Bytes() - HEADER_BYTES_) / sizeof(ElemT) : 0;
+  }
+
+  [[nodiscard]] inline ElemT& At(const size_t index) {
+    return buffer_[index];
+  }
+
+  [[nodiscard]] inline const ElemT& At(const size_t index) const {
+    return buffer_[index];
+  }
+
+  void Resize(const size_t new_size) {
+    const size_t size = Size();
+    if (new_size == size) {
+      return;
+    }
+    if (new_size > size) {
+      Reserve(new_size);
+      std::uninitialized_value_construct(buffer_ + size, buffer_ + new_size);
+    }
+    header_->size = new_size;
+  }
+
+  void ResizeDefaultInit(const size_t new_size) {
+    if (new_size == Size()) {
+      return;
+    }
+    Reserve(new_size);
+    header_->size = new_size;
+  }
+
+  ElemT* ReserveBack() {
+    return ReserveBack(1);
+  }
+
+  void RollBackReservedBack() {
+    --header_->size;
+  }
+
+  ElemT* ReserveBack(const size_t count) {
+    const size_t size = Size();
+    if (size + count > Capacity()) {
+      Grow(std::max(size + count, 2 * Capacity()));
+    }
+    header_->size = size + count;
+    return buffer_ + size;
+  }
+
+  void RollBackReservedBack(const size_t count) {
+    header_->size -= count;
+  }
+
+  void Reserve(const size_t capacity) {
+    if (capacity > Capacity()) {
+      Grow(capacity);
+    }
+  }
+
+  // Gives the pages past the last element back, truncating the file along with the mapping.
+  void Shrink() {
+    if (header_ != nullptr && BytesFor(Size()) < region_.Bytes()) {
+      region_.Resize(BytesFor(Size()));
+      UpdatePointers();
+    }
+  }
+
+  [[nodiscard]] inline ElemT* Buffer() {
+    return buffer_;
+  }
+
+  [[nodiscard]] inline const ElemT* Buffer() const {
+    return buffer_;
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    return Size() == 0 || CallSegment(func, buffer_, Size());
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return Size() == 0 || CallSegment(func, static_cast<const ElemT*>(buffer_), Size());
+  }
+
+  // Writes dirty pages back to the file; a no-op for anonymous storages.
+  void Sync(const bool async = false) const {
+    if (region_.File().IsOpen()) {
+      region_.Sync(async);
+    }
+  }
+
+  // DontNeed is ignored for anonymous storages, which have no file to read the pages back from.
+  void Advise(const MmapAdvice advice) const {
+    if (header_ != nullptr) {
+      region_.Advise(static_cast<int>(advice));
+    }
+  }
+
+  [[nodiscard]] inline bool IsFileBacked() const {
+    return region_.File().IsOpen();
+  }
+
+ private:
+  static size_t BytesFor(const size_t capacity) {
+    return RoundUpToPages(HEADER_BYTES_ + std::max<size_t>(capacity, 1) * sizeof(ElemT));
+  }
+
+  void Grow(const size_t capacity) {
+    if (header_ == nullptr) {
+      region_ = MappedRegion(BytesFor(capacity));
+      InitHeader();
+    } else {
+      region_.Resize(BytesFor(capacity));
+      UpdatePointers();
+    }
+  }
+
+  void InitHeader() {
+    UpdatePointers();
+    *header_ = MmapHeader{MmapHeader::MAGIC, MmapHeader::VERSION,
+                          sizeof(ElemT), alignof(ElemT), 0, 0};
+  }
+
+  void CheckHeader() const {
+    if (header_->magic != MmapHeader::MAGIC || header_->version != MmapHeader::VERSION ||
+        header_->elem_size != sizeof(ElemT) || header_->elem_align != alignof(ElemT) ||
+        header_->size > Capacity()) {
+      throw std::runtime_error(BAD_MMAP_HEADER_MSG);
+    }
+  }
+
+  void UpdatePointers() {
+    auto* data = static_cast<unsigned char*>(region_.Data());
+    header_ = reinterpret_cast<MmapHeader*>(data);
+    buffer_ = reinterpret_cast<ElemT*>(data + HEADER_BYTES_);
+  }
+
+  void SwapFields(MmapStorage& other) {
+    std::swap(region_, other.region_);
+    std::swap(header_, other.header_);
+    std::swap(buffer_, other.buffer_);
+  }
+
+ private:
+  MappedRegion region_;
+
+  MmapHeader* header_{nullptr};
+  ElemT* buffer_{nullptr};
+
+};
+
+#endif /* mmap_storage.hpp */
@@ -0,0 +1,144 @@
+#ifndef NUMERIC_ALGORITHMS_HPP
+#define NUMERIC_ALGORITHMS_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+#include "error_msgs.hpp"
+#include "segmented_algorithms.hpp"
+#include "simd_kernels.hpp"
+
+// Reductions and element-wise arithmetic over numeric Vectors. Every contiguous segment
+// of the storage (the whole buffer, or one chunk of ChunkedStorage) goes to a SIMD kernel.
+
+template<typename VectorT>
+concept NumericVector = SimdArithmetic<typename std::remove_const_t<VectorT>::value_type>;
+
+// Calls func(lhs_data, rhs_data, count) over matching ranges of two vectors of the same size.
+// rhs is read in place when it is contiguous or segmented like lhs, otherwise through a
+// small buffer.
+template<typename LhsVector, typename RhsVector, typename FuncT>
+void ZipSegments(LhsVector& lhs, const RhsVector& rhs, FuncT&& func) {
+  if (lhs.Size() != rhs.Size()) {
+    throw std::invalid_argument(BAD_SIZE_MISMATCH);
+  }
+
+  using ElemT = typename RhsVector::value_type;
+  static constexpr size_t BLOCK_SIZE = 256;
+
+  size_t offset = 0;
+  lhs.ForEachSegment([&](auto* data, const size_t count) {
+    if constexpr (RhsVector::IS_CONTIGUOUS) {
+      func(data, rhs.Data() + offset, count);
+    } else if constexpr (std::is_same_v<std::remove_const_t<LhsVector>, RhsVector>) {
+      func(data, &rhs.At(offset), count);
+    } else {
+      ElemT block[BLOCK_SIZE];
+      for (size_t done = 0; done < count; done += BLOCK_SIZE) {
+        const size_t block_size = std::min(BLOCK_SIZE, count - done);
+        for (size_t i = 0; i < block_size; ++i) {
+          block[i] = rhs.At(offset + done + i);
+        }
+        func(data + done, static_cast<const ElemT*>(block), block_size);
+      }
+    }
+    offset += count;
+  });
+}
+
+template<NumericVector VectorT>
+typename VectorT::value_type Sum(const VectorT& vector) {
+  using ElemT = typename VectorT::value_type;
+
+  ElemT sum = 0;
+  vector.ForEachSegment([&sum](const ElemT* data, const size_t count) {
+    sum += SimdSum(data, count);
+  });
+  return sum;
+}
+
+template<NumericVector VectorT>
+MinMaxPair<typename VectorT::value_type> MinMax(const VectorT& vector) {
+  using ElemT = typename VectorT::value_type;
+
+  if (vector.Size() == 0) {
+    throw std::logic_error(BAD_EMPTY_REDUCE_MSG);
+  }
+
+  MinMaxPair<ElemT> result{vector.At(0), vector.At(0)};
+  vector.ForEachSegment([&result](const ElemT* data, const size_t count) {
+    const MinMaxPair<ElemT> segment = SimdMinMax(data, count);
+    result.first = std::min(result.first, segment.first);
+    result.second = std::max(result.second, segment.second);
+  });
+  return result;
+}
+
+template<NumericVector VectorT>
+typename VectorT::value_type Min(const VectorT& vector) {
+  return MinMax(vector).first;
+}
+
+template<NumericVector VectorT>
+typename VectorT::value_type Max(const VectorT& vector) {
+  return MinMax(vector).second;
+}
+
+template<NumericVector LhsVector, NumericVector RhsVector>
+typename LhsVector::value_type Dot(const LhsVector& lhs, const RhsVector& rhs) {
+  using ElemT = typename LhsVector::value_type;
+  static_assert(std::is_same_v<ElemT, typename RhsVector::value_type>);
+
+  ElemT dot = 0;
+  ZipSegments(lhs, rhs, [&dot](const ElemT* lhs_data, const ElemT* rhs_data, const size_t count) {
+    dot += SimdDot(lhs_data, rhs_data, count);
+  });
+  return dot;
+}
+
+// vector[i] *= factor
+template<NumericVector VectorT>
+void Scale(VectorT& vector, const typename VectorT::value_type factor) {
+  using ElemT = typename VectorT::value_type;
+
+  vector.ForEachSegment([factor](ElemT* data, const size_t count) {
+    SimdScale(data, count, factor);
+  });
+}
+
+// dst[i] += factor * src[i]
+template<NumericVector DstVector, NumericVector SrcVector>
+void Axpy(DstVector& dst, const typename DstVector::value_type factor, const SrcVector& src) {
+  using ElemT = typename DstVector::value_type;
+  static_assert(std::is_same_v<ElemT, typename SrcVector::value_type>);
+
+  ZipSegments(dst, src, [factor](ElemT* dst_data, const ElemT* src_data, const size_t count) {
+    SimdAxpy(dst_data, src_data, count, factor);
+  });
+}
+
+// dst[i] += src[i]
+template<NumericVector DstVector, NumericVector SrcVector>
+void Add(DstVector& dst, const SrcVector& src) {
+  using ElemT = typename DstVector::value_type;
+  static_assert(std::is_same_v<ElemT, typename SrcVector::value_type>);
+
+  ZipSegments(dst, src, [](ElemT* dst_data, const ElemT* src_data, const size_t count) {
+    SimdAdd(dst_data, src_data, count);
+  });
+}
+
+// dst[i] *= src[i]
+template<NumericVector DstVector, NumericVector SrcVector>
+void Mul(DstVector& dst, const SrcVector& src) {
+  using ElemT = typename DstVector::value_type;
+  static_assert(std::is_same_v<ElemT, typename SrcVector::value_type>);
+
+  ZipSegments(dst, src, [](ElemT* dst_data, const ElemT* src_data, const size_t count) {
+    SimdMul(dst_data, src_data, count);
+  });
+}
+
+#endif /* numeric_algorithms.hpp */
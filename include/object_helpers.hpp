@@ -3,6 +3,20 @@
 
 #include <new>
 #include <cassert>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+// Relocation traits
+
+template<typename ElemT>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<ElemT> {
+};
+
+template<typename ElemT>
+inline constexpr bool IS_TRIVIALLY_RELOCATABLE = IsTriviallyRelocatable<ElemT>::value;
+
+// Construction and destruction
 
 template<typename ElemT, typename... ArgsT>
 inline void ConstructOne(ElemT* elem, ArgsT&&... args) {
@@ -35,6 +49,19 @@ inline size_t DefaultConstruct(ElemT* buffer, const size_t size) {
   return DefaultConstruct(buffer, 0, size);
 }
 
+// Default-initializes [first, last): trivially default constructible elements are left unset.
+template<typename ElemT>
+inline size_t DefaultInit(ElemT* buffer, const size_t first, const size_t last) {
+  assert(buffer != nullptr || first == last);
+
+  if constexpr (!std::is_trivially_default_constructible_v<ElemT>) {
+    for (size_t i = first; i < last; ++i) {
+      new (buffer + i) ElemT;
+    }
+  }
+  return last;
+}
+
 template<typename ElemT>
 inline size_t Construct(ElemT* buffer, const size_t size, const ElemT& value) {
   assert(buffer != nullptr);
@@ -74,11 +101,17 @@ inline void DestructAndDelete(ElemT* buffer, const size_t size) {
   ::operator delete(buffer);
 }
 
-template<typename ElemT>
-ElemT* SafeCopy(ElemT* src, const size_t dst_size, const size_t src_size) {
+template<typename AllocatorT, typename ElemT>
+inline void DestructAndDelete(AllocatorT& allocator, ElemT* buffer, const size_t size, const size_t capacity) {
+  Destruct(buffer, size);
+  allocator.deallocate(buffer, capacity);
+}
+
+template<typename AllocatorT, typename ElemT>
+ElemT* SafeCopyElementwise(AllocatorT& allocator, const ElemT* src, const size_t dst_size, const size_t src_size) {
   assert(src_size <= dst_size);
 
-  ElemT* dst = static_cast<ElemT*>(::operator new(dst_size * sizeof(ElemT)));
+  ElemT* dst = allocator.allocate(dst_size);
   size_t constructed = 0;
   try {
     for (size_t i = 0; i < src_size; ++i) {
@@ -86,18 +119,18 @@ ElemT* SafeCopy(ElemT* src, const size_t dst_size, const size_t src_size) {
       ++constructed;
     }
   } catch (...) {
-    DestructAndDelete(dst, constructed);
+    DestructAndDelete(allocator, dst, constructed, dst_size);
     throw;
   }
 
   return dst;
 }
 
-template<typename ElemT>
-ElemT* SafeMove(ElemT* src, const size_t dst_size, const size_t src_size) {
+template<typename AllocatorT, typename ElemT>
+ElemT* SafeMoveElementwise(AllocatorT& allocator, ElemT* src, const size_t dst_size, const size_t src_size) {
   assert(src_size <= dst_size);
 
-  ElemT* dst = static_cast<ElemT*>(::operator new(dst_size * sizeof(ElemT)));
+  ElemT* dst = allocator.allocate(dst_size);
   size_t constructed = 0;
   try {
     for (size_t i = 0; i < src_size; ++i) {
@@ -105,11 +138,88 @@ ElemT* SafeMove(ElemT* src, const size_t dst_size, const size_t src_size) {
       ++constructed;
     }
   } catch (...) {
-    DestructAndDelete(dst, constructed);
+    DestructAndDelete(allocator, dst, constructed, dst_size);
     throw;
   }
 
   return dst;
 }
 
+template<typename AllocatorT, typename ElemT>
+ElemT* BitwiseCopy(AllocatorT& allocator, const ElemT* src, const size_t dst_size, const size_t src_size) {
+  assert(src_size <= dst_size);
+
+  ElemT* dst = allocator.allocate(dst_size);
+  if (src_size != 0) {
+    std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), src_size * sizeof(ElemT));
+  }
+
+  return dst;
+}
+
+template<typename AllocatorT, typename ElemT>
+ElemT* SafeCopy(AllocatorT& allocator, const ElemT* src, const size_t dst_size, const size_t src_size) {
+  if constexpr (std::is_trivially_copyable_v<ElemT>) {
+    return BitwiseCopy(allocator, src, dst_size, src_size);
+  } else {
+    return SafeCopyElementwise(allocator, src, dst_size, src_size);
+  }
+}
+
+template<typename AllocatorT, typename ElemT>
+ElemT* SafeMove(AllocatorT& allocator, ElemT* src, const size_t dst_size, const size_t src_size) {
+  if constexpr (std::is_trivially_copyable_v<ElemT>) {
+    return BitwiseCopy(allocator, src, dst_size, src_size);
+  } else {
+    return SafeMoveElementwise(allocator, src, dst_size, src_size);
+  }
+}
+
+// Moves size elements from src into uninitialized dst and ends their lifetime in src.
+template<typename ElemT>
+void RelocateTo(ElemT* dst, ElemT* src, const size_t size) {
+  if constexpr (IS_TRIVIALLY_RELOCATABLE<ElemT>) {
+    if (size != 0) {
+      std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), size * sizeof(ElemT));
+    }
+  } else {
+    size_t constructed = 0;
+    try {
+      for (; constructed < size; ++constructed) {
+        ConstructOne(dst + constructed, std::move_if_noexcept(src[constructed]));
+      }
+    } catch (...) {
+      Destruct(dst, constructed);
+      throw;
+    }
+    Destruct(src, size);
+  }
+}
+
+// Moves src_size elements into a new buffer of dst_size and ends their lifetime in src,
+// so the caller only has to release src's memory.
+template<typename AllocatorT, typename ElemT>
+ElemT* Relocate(AllocatorT& allocator, ElemT* src, const size_t dst_size, const size_t src_size) {
+  if constexpr (IS_TRIVIALLY_RELOCATABLE<ElemT>) {
+    return BitwiseCopy(allocator, src, dst_size, src_size);
+  } else {
+    ElemT* dst = SafeMoveElementwise(allocator, src, dst_size, src_size);
+    Destruct(src, src_size);
+    return dst;
+  }
+}
+
+// Segment callbacks
+
+// Calls a ForEachSegment callback. Callbacks may return void, or bool where false stops the walk.
+template<typename FuncT, typename ElemT>
+inline bool CallSegment(FuncT& func, ElemT* data, const size_t count) {
+  if constexpr (std::is_same_v<std::invoke_result_t<FuncT&, ElemT*, size_t>, bool>) {
+    return func(data, count);
+  } else {
+    func(data, count);
+    return true;
+  }
+}
+
 #endif /* object_helpers.hpp */
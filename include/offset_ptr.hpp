@@ -0,0 +1,67 @@
+#ifndef OFFSET_PTR_HPP
+#define OFFSET_PTR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Pointer stored as the distance from itself to the target, so it stays valid when the
+// memory holding both is mapped at another address, by another process or after mremap.
+// Copying recomputes the distance, and the target must live in the same mapping.
+template<typename T>
+class OffsetPtr {
+ public:
+  OffsetPtr() = default;
+
+  OffsetPtr(T* ptr) {
+    Set(ptr);
+  }
+
+  OffsetPtr(const OffsetPtr& other_copy) {
+    Set(other_copy.Get());
+  }
+
+  OffsetPtr& operator=(const OffsetPtr& other_copy) {
+    Set(other_copy.Get());
+    return *this;
+  }
+
+  OffsetPtr& operator=(T* ptr) {
+    Set(ptr);
+    return *this;
+  }
+
+  ~OffsetPtr() = default;
+
+  [[nodiscard]] inline T* Get() const {
+    if (offset_ == NULL_OFFSET_) {
+      return nullptr;
+    }
+    return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + offset_);
+  }
+
+  inline T& operator*() const {
+    return *Get();
+  }
+
+  inline T* operator->() const {
+    return Get();
+  }
+
+  explicit inline operator bool() const {
+    return offset_ != NULL_OFFSET_;
+  }
+
+ private:
+  void Set(T* ptr) {
+    offset_ = ptr == nullptr ? NULL_OFFSET_ :
+      static_cast<ptrdiff_t>(reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(this));
+  }
+
+  // No object starts one byte past the pointer that refers to it.
+  static constexpr ptrdiff_t NULL_OFFSET_ = 1;
+
+  ptrdiff_t offset_{NULL_OFFSET_};
+
+};
+
+#endif /* offset_ptr.hpp */
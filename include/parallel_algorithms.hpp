@@ -0,0 +1,245 @@
+#ifndef PARALLEL_ALGORITHMS_HPP
+#define PARALLEL_ALGORITHMS_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "error_msgs.hpp"
+#include "vector.hpp"
+#include "thread_pool.hpp"
+
+// Algorithms that cut a Vector into index ranges and run them on a ThreadPool. Contiguous
+// storages are cut anywhere; ChunkedStorage is cut at chunk boundaries, so no two tasks
+// ever write to the same chunk.
+
+// Number of elements a range boundary has to be a multiple of.
+template<typename StorageT>
+inline constexpr size_t PARALLEL_GRAIN = 1;
+
+template<typename ElemT, size_t N, typename Geometry>
+inline constexpr size_t PARALLEL_GRAIN<ChunkedStorage<ElemT, N, Geometry>> =
+  ChunkedStorage<ElemT, N, Geometry>::FULL_CHUNK_SIZE_;
+
+template<typename VectorT>
+concept ParallelVector = requires {
+  typename std::remove_const_t<VectorT>::storage_type;
+} && (std::remove_const_t<VectorT>::IS_CONTIGUOUS ||
+      PARALLEL_GRAIN<typename std::remove_const_t<VectorT>::storage_type> > 1);
+
+template<ParallelVector VectorT>
+inline constexpr size_t VECTOR_GRAIN = PARALLEL_GRAIN<typename std::remove_const_t<VectorT>::storage_type>;
+
+// Splits [0, size) into ranges made of whole grains: a few per thread, so that stealing can
+// even out slow tasks, but none much shorter than MIN_TASK_SIZE elements.
+class RangeSplit {
+ public:
+  static constexpr size_t MIN_TASK_SIZE = 1 << 14;
+  static constexpr size_t TASKS_PER_THREAD = 4;
+
+ public:
+  RangeSplit(const size_t size, const size_t grain, const size_t threads_cnt) :
+    size_{size}, grain_{grain}, grains_cnt_{(size + grain - 1) / grain} {
+    const size_t by_size = (size + MIN_TASK_SIZE - 1) / MIN_TASK_SIZE;
+    tasks_cnt_ = std::min({grains_cnt_, by_size, threads_cnt * TASKS_PER_THREAD});
+  }
+
+  [[nodiscard]] inline size_t TasksCnt() const {
+    return tasks_cnt_;
+  }
+
+  [[nodiscard]] inline size_t Begin(const size_t task) const {
+    return std::min(size_, grains_cnt_ * task / tasks_cnt_ * grain_);
+  }
+
+  [[nodiscard]] inline size_t End(const size_t task) const {
+    return Begin(task + 1);
+  }
+
+ private:
+  size_t size_{0};
+  size_t grain_{1};
+  size_t grains_cnt_{0};
+  size_t tasks_cnt_{0};
+
+};
+
+// Constructs the lazy chunks of a ChunkedStorage up front: tasks must only read the chunk
+// table, never fill it in.
+template<ParallelVector VectorT>
+void PrepareSegments(VectorT& vector) {
+  if constexpr (!std::remove_const_t<VectorT>::IS_CONTIGUOUS) {
+    vector.ForEachSegment([](const auto*, const size_t) {
+    });
+  }
+}
+
+// Calls func(data, count, offset) for the contiguous pieces of [begin, end).
+template<ParallelVector VectorT, typename FuncT>
+void ForEachSegmentIn(VectorT& vector, const size_t begin, const size_t end, FuncT&& func) {
+  if constexpr (std::remove_const_t<VectorT>::IS_CONTIGUOUS) {
+    func(vector.Data() + begin, end - begin, begin);
+  } else {
+    static constexpr size_t GRAIN = VECTOR_GRAIN<VectorT>;
+    for (size_t offset = begin; offset < end;) {
+      const size_t count = std::min(GRAIN - offset % GRAIN, end - offset);
+      func(&vector.At(offset), count, offset);
+      offset += count;
+    }
+  }
+}
+
+// Calls func(task, begin, end) for every range of the vector's split on pool.
+template<ParallelVector VectorT, typename FuncT>
+void ParallelRanges(VectorT& vector, ThreadPool& pool, FuncT&& func) {
+  PrepareSegments(vector);
+  const RangeSplit split(vector.Size(), VECTOR_GRAIN<VectorT>, pool.ThreadsCnt());
+  pool.Run(split.TasksCnt(), [&split, &func](const size_t task) {
+    func(task, split.Begin(task), split.End(task));
+  });
+}
+
+// Calls func(elem) for every element. Calls for different elements may run concurrently.
+template<ParallelVector VectorT, typename FuncT>
+void ParallelForEach(VectorT& vector, FuncT func, ThreadPool& pool = ThreadPool::Default()) {
+  ParallelRanges(vector, pool, [&vector, &func](size_t, const size_t begin, const size_t end) {
+    ForEachSegmentIn(vector, begin, end, [&func](auto* data, const size_t count, size_t) {
+      for (size_t i = 0; i < count; ++i) {
+        func(data[i]);
+      }
+    });
+  });
+}
+
+// dst[i] = func(src[i]). The work is split along dst, so a chunked src that is segmented
+// differently is read element by element.
+template<ParallelVector SrcVector, ParallelVector DstVector, typename FuncT>
+void ParallelTransform(const SrcVector& src, DstVector& dst, FuncT func, ThreadPool& pool = ThreadPool::Default()) {
+  if (src.Size() != dst.Size()) {
+    throw std::invalid_argument(BAD_SIZE_MISMATCH);
+  }
+
+  PrepareSegments(src);
+  ParallelRanges(dst, pool, [&src, &dst, &func](size_t, const size_t begin, const size_t end) {
+    ForEachSegmentIn(dst, begin, end, [&src, &func](auto* data, const size_t count, const size_t offset) {
+      if constexpr (SrcVector::IS_CONTIGUOUS || VECTOR_GRAIN<SrcVector> == VECTOR_GRAIN<DstVector>) {
+        const auto* src_data = &src.At(offset);
+        for (size_t i = 0; i < count; ++i) {
+          data[i] = func(src_data[i]);
+        }
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          data[i] = func(src.At(offset + i));
+        }
+      }
+    });
+  });
+}
+
+// Folds every range from its first element, then folds init and the partial results in
+// range order. op must be associative; the result does not depend on the thread count.
+template<ParallelVector VectorT, typename T, typename OpT = std::plus<>>
+T ParallelReduce(const VectorT& vector, T init, OpT op = OpT{}, ThreadPool& pool = ThreadPool::Default()) {
+  PrepareSegments(vector);
+  const RangeSplit split(vector.Size(), VECTOR_GRAIN<VectorT>, pool.ThreadsCnt());
+  Vector<T> partials(split.TasksCnt(), init);
+
+  pool.Run(split.TasksCnt(), [&](const size_t task) {
+    T& partial = partials.At(task);
+    bool first = true;
+    ForEachSegmentIn(vector, split.Begin(task), split.End(task), [&](const auto* data, const size_t count, size_t) {
+      size_t i = 0;
+      if (first) {
+        partial = data[0];
+        first = false;
+        i = 1;
+      }
+      for (; i < count; ++i) {
+        partial = op(std::move(partial), data[i]);
+      }
+    });
+  });
+
+  for (size_t i = 0; i < partials.Size(); ++i) {
+    init = op(std::move(init), std::move(partials.At(i)));
+  }
+  return init;
+}
+
+template<typename SrcIt, typename DstIt, typename CompT>
+void MergeRuns(SrcIt src, DstIt dst, const size_t begin, const size_t middle, const size_t end, CompT& comp) {
+  std::merge(std::make_move_iterator(src + begin), std::make_move_iterator(src + middle),
+             std::make_move_iterator(src + middle), std::make_move_iterator(src + end),
+             dst + begin, comp);
+}
+
+// Not stable. Every range is sorted on its own, then neighbouring runs are merged pairwise,
+// each round in parallel, bouncing between the vector and a scratch buffer. A chunked
+// vector is gathered into the buffer first so that the runs are sorted contiguously.
+template<ParallelVector VectorT, typename CompT = std::less<>>
+void ParallelSort(VectorT& vector, CompT comp = CompT{}, ThreadPool& pool = ThreadPool::Default()) {
+  using ElemT = typename VectorT::value_type;
+
+  PrepareSegments(vector);
+  const size_t size = vector.Size();
+  const RangeSplit split(size, VECTOR_GRAIN<VectorT>, pool.ThreadsCnt());
+  const size_t runs_cnt = split.TasksCnt();
+
+  auto elems = [&vector] {
+    if constexpr (VectorT::IS_CONTIGUOUS) {
+      return vector.Data();
+    } else {
+      return vector.begin();
+    }
+  }();
+
+  if (runs_cnt <= 1) {
+    std::sort(elems, elems + size, comp);
+    return;
+  }
+
+  Vector<ElemT> buffer;
+  buffer.ResizeDefaultInit(size);
+  ElemT* scratch = buffer.Data();
+
+  bool in_buffer = !VectorT::IS_CONTIGUOUS;
+  pool.Run(runs_cnt, [&](const size_t run) {
+    if constexpr (VectorT::IS_CONTIGUOUS) {
+      std::sort(elems + split.Begin(run), elems + split.End(run), comp);
+    } else {
+      ForEachSegmentIn(vector, split.Begin(run), split.End(run), [scratch](ElemT* data, const size_t count, const size_t offset) {
+        std::move(data, data + count, scratch + offset);
+      });
+      std::sort(scratch + split.Begin(run), scratch + split.End(run), comp);
+    }
+  });
+
+  for (size_t width = 1; width < runs_cnt; width *= 2) {
+    pool.Run((runs_cnt + 2 * width - 1) / (2 * width), [&](const size_t merge) {
+      const size_t first_run = 2 * width * merge;
+      const size_t begin = split.Begin(first_run);
+      const size_t middle = split.Begin(std::min(first_run + width, runs_cnt));
+      const size_t end = split.Begin(std::min(first_run + 2 * width, runs_cnt));
+      if (in_buffer) {
+        MergeRuns(scratch, elems, begin, middle, end, comp);
+      } else {
+        MergeRuns(elems, scratch, begin, middle, end, comp);
+      }
+    });
+    in_buffer = !in_buffer;
+  }
+
+  if (in_buffer) {
+    ParallelRanges(vector, pool, [&vector, scratch](size_t, const size_t begin, const size_t end) {
+      ForEachSegmentIn(vector, begin, end, [scratch](ElemT* data, const size_t count, const size_t offset) {
+        std::move(scratch + offset, scratch + offset + count, data);
+      });
+    });
+  }
+}
+
+#endif /* parallel_algorithms.hpp */
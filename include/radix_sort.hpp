@@ -0,0 +1,438 @@
+#ifndef RADIX_SORT_HPP
+#define RADIX_SORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <concepts>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+#include "parallel_algorithms.hpp"
+#include "thread_pool.hpp"
+
+// Byte-wise radix sorts for Vectors of integers, floats and (key, payload) pairs ordered by
+// key. Both sorts use one scratch buffer of Size() elements, allocated through the vector's
+// allocator when the storage has one, and can spread their passes over a ThreadPool.
+//
+// StableRadixSort is LSD: equal keys keep their order. RadixSort splits on the highest
+// byte that differs and sorts the buckets independently; it orders by key only, so equal
+// keys may come out in any order. Floats order as their bit patterns do: -0.0 before 0.0,
+// NaNs at either end by sign.
+
+// Maps an element to unsigned bits that compare like its key.
+template<typename ElemT>
+struct RadixKey;
+
+template<std::unsigned_integral ElemT>
+  requires (!std::is_same_v<ElemT, bool>)
+struct RadixKey<ElemT> {
+  using Bits = ElemT;
+
+  static inline Bits Get(const ElemT elem) {
+    return elem;
+  }
+};
+
+template<std::signed_integral ElemT>
+struct RadixKey<ElemT> {
+  using Bits = std::make_unsigned_t<ElemT>;
+
+  static inline Bits Get(const ElemT elem) {
+    return static_cast<Bits>(elem) ^ (Bits{1} << (8 * sizeof(Bits) - 1));
+  }
+};
+
+template<std::floating_point ElemT>
+  requires (sizeof(ElemT) == 4 || sizeof(ElemT) == 8)
+struct RadixKey<ElemT> {
+  using Bits = std::conditional_t<sizeof(ElemT) == 4, uint32_t, uint64_t>;
+
+  static inline Bits Get(const ElemT elem) {
+    static constexpr Bits SIGN = Bits{1} << (8 * sizeof(Bits) - 1);
+    Bits bits;
+    std::memcpy(&bits, &elem, sizeof(bits));
+    return (bits & SIGN) != 0 ? ~bits : bits | SIGN;
+  }
+};
+
+template<typename KeyT, typename PayloadT>
+struct RadixKey<std::pair<KeyT, PayloadT>> {
+  using Bits = typename RadixKey<KeyT>::Bits;
+
+  static inline Bits Get(const std::pair<KeyT, PayloadT>& elem) {
+    return RadixKey<KeyT>::Get(elem.first);
+  }
+};
+
+template<typename ElemT>
+concept RadixSortable = std::is_default_constructible_v<ElemT> && requires(const ElemT& elem) {
+  { RadixKey<ElemT>::Get(elem) } -> std::unsigned_integral;
+};
+
+template<typename VectorT>
+concept RadixSortableVector = ParallelVector<VectorT> && RadixSortable<typename VectorT::value_type>;
+
+static constexpr size_t RADIX = 256;
+static constexpr size_t RADIX_BITS = 8;
+
+using RadixHistogram = std::array<size_t, RADIX>;
+
+template<typename ElemT>
+inline auto RadixBits(const ElemT& elem) {
+  return RadixKey<ElemT>::Get(elem);
+}
+
+template<typename ElemT>
+inline size_t RadixDigit(const ElemT& elem, const size_t digit) {
+  return (RadixBits(elem) >> (RADIX_BITS * digit)) & (RADIX - 1);
+}
+
+// Default-constructed elements in memory from AllocatorT.
+template<typename ElemT, typename AllocatorT>
+class RadixScratch {
+ public:
+  RadixScratch(const AllocatorT& allocator, const size_t size) : allocator_(allocator), size_{size} {
+    data_ = Traits::allocate(allocator_, size_);
+    try {
+      std::uninitialized_default_construct_n(data_, size_);
+    } catch (...) {
+      Traits::deallocate(allocator_, data_, size_);
+      throw;
+    }
+  }
+
+  RadixScratch(const RadixScratch&) = delete;
+  RadixScratch& operator=(const RadixScratch&) = delete;
+
+  ~RadixScratch() {
+    std::destroy_n(data_, size_);
+    Traits::deallocate(allocator_, data_, size_);
+  }
+
+  [[nodiscard]] inline ElemT* Data() {
+    return data_;
+  }
+
+ private:
+  using Traits = std::allocator_traits<AllocatorT>;
+
+  AllocatorT allocator_;
+  ElemT* data_{nullptr};
+  size_t size_{0};
+
+};
+
+template<typename VectorT>
+auto RadixScratchAllocator(const VectorT& vector) {
+  if constexpr (requires { vector.GetAllocator(); }) {
+    return vector.GetAllocator();
+  } else {
+    return std::allocator<typename VectorT::value_type>();
+  }
+}
+
+// One end of a radix pass. The vector and the scratch buffer share the index space, so
+// a pass over [begin, end) of one side scatters into [begin, end) of the other.
+template<typename ElemT>
+struct RadixBufferSide {
+  ElemT* data;
+
+  template<typename FuncT>
+  inline void ForEach(const size_t begin, const size_t end, FuncT&& func) {
+    func(data + begin, end - begin, begin);
+  }
+
+  inline ElemT& operator[](const size_t index) {
+    return data[index];
+  }
+};
+
+template<typename VectorT>
+struct RadixVectorSide {
+  VectorT& vector;
+
+  template<typename FuncT>
+  inline void ForEach(const size_t begin, const size_t end, FuncT&& func) {
+    ForEachSegmentIn(vector, begin, end, func);
+  }
+
+  inline typename VectorT::value_type& operator[](const size_t index) {
+    return vector.At(index);
+  }
+};
+
+template<typename VectorT>
+auto MakeRadixSide(VectorT& vector) {
+  if constexpr (VectorT::IS_CONTIGUOUS) {
+    return RadixBufferSide<typename VectorT::value_type>{vector.Data()};
+  } else {
+    return RadixVectorSide<VectorT>{vector};
+  }
+}
+
+// Adds the digits [0, digits_cnt) of every key in [begin, end) to histograms[digit].
+template<typename SideT>
+void CountDigits(SideT& side, const size_t begin, const size_t end, const size_t digits_cnt,
+                 RadixHistogram* histograms) {
+  side.ForEach(begin, end, [digits_cnt, histograms](const auto* data, const size_t count, size_t) {
+    for (size_t i = 0; i < count; ++i) {
+      const auto bits = RadixBits(data[i]);
+      for (size_t digit = 0; digit < digits_cnt; ++digit) {
+        ++histograms[digit][(bits >> (RADIX_BITS * digit)) & (RADIX - 1)];
+      }
+    }
+  });
+}
+
+// Moves [begin, end) of src to dst, each element to the next free slot of its bucket.
+// offsets holds those slots and is advanced.
+template<typename SrcSide, typename DstSide>
+void ScatterDigit(SrcSide& src, DstSide& dst, const size_t begin, const size_t end, const size_t digit,
+                  RadixHistogram& offsets) {
+  src.ForEach(begin, end, [&dst, digit, &offsets](auto* data, const size_t count, size_t) {
+    for (size_t i = 0; i < count; ++i) {
+      dst[offsets[RadixDigit(data[i], digit)]++] = std::move(data[i]);
+    }
+  });
+}
+
+inline bool IsSingleBucket(const RadixHistogram& histogram, const size_t count) {
+  return std::find(histogram.begin(), histogram.end(), count) != histogram.end();
+}
+
+template<typename FuncT>
+void RunRadixTasks(ThreadPool* pool, const size_t tasks_cnt, FuncT&& func) {
+  if (pool == nullptr) {
+    for (size_t task = 0; task < tasks_cnt; ++task) {
+      func(task);
+    }
+  } else {
+    pool->Run(tasks_cnt, func);
+  }
+}
+
+// Sorts [begin, end) stably by the low digits_cnt digits, bouncing between a and b and
+// skipping digits all keys share. Returns whether the result ended up in b.
+template<typename ASide, typename BSide>
+bool LsdSortRange(ASide& a, BSide& b, const size_t begin, const size_t end, const size_t digits_cnt) {
+  RadixHistogram histograms[sizeof(uint64_t)] = {};
+  CountDigits(a, begin, end, digits_cnt, histograms);
+
+  bool in_b = false;
+  for (size_t digit = 0; digit < digits_cnt; ++digit) {
+    RadixHistogram& offsets = histograms[digit];
+    if (IsSingleBucket(offsets, end - begin)) {
+      continue;
+    }
+
+    size_t slot = begin;
+    for (size_t& bucket : offsets) {
+      slot += std::exchange(bucket, slot);
+    }
+    if (in_b) {
+      ScatterDigit(b, a, begin, end, digit, offsets);
+    } else {
+      ScatterDigit(a, b, begin, end, digit, offsets);
+    }
+    in_b = !in_b;
+  }
+  return in_b;
+}
+
+// Per-task histograms of every digit, plus their sum in the last slot.
+template<typename SideT>
+Vector<std::array<RadixHistogram, sizeof(uint64_t)>> CountDigitsByTask(
+  SideT& side, const RangeSplit& split, const size_t digits_cnt, ThreadPool* pool) {
+  const size_t tasks_cnt = split.TasksCnt();
+  Vector<std::array<RadixHistogram, sizeof(uint64_t)>> histograms(tasks_cnt + 1);
+
+  RunRadixTasks(pool, tasks_cnt, [&](const size_t task) {
+    CountDigits(side, split.Begin(task), split.End(task), digits_cnt, histograms.At(task).data());
+  });
+  for (size_t task = 0; task < tasks_cnt; ++task) {
+    for (size_t digit = 0; digit < digits_cnt; ++digit) {
+      for (size_t bucket = 0; bucket < RADIX; ++bucket) {
+        histograms.At(tasks_cnt)[digit][bucket] += histograms.At(task)[digit][bucket];
+      }
+    }
+  }
+  return histograms;
+}
+
+// One stable pass over the whole array on split's tasks: each task scatters its own range
+// into slots that follow those of every earlier task in the same bucket.
+template<typename SrcSide, typename DstSide, typename HistogramsT>
+void ScatterDigitByTask(SrcSide& src, DstSide& dst, const RangeSplit& split, const size_t digit,
+                        HistogramsT& histograms, ThreadPool* pool) {
+  const size_t tasks_cnt = split.TasksCnt();
+  size_t slot = 0;
+  for (size_t bucket = 0; bucket < RADIX; ++bucket) {
+    for (size_t task = 0; task < tasks_cnt; ++task) {
+      slot += std::exchange(histograms.At(task)[digit][bucket], slot);
+    }
+  }
+
+  RunRadixTasks(pool, tasks_cnt, [&](const size_t task) {
+    ScatterDigit(src, dst, split.Begin(task), split.End(task), digit, histograms.At(task)[digit]);
+  });
+}
+
+// After a pass, per-task histograms no longer describe the permuted ranges; recounts one digit.
+template<typename SideT, typename HistogramsT>
+void RecountDigitByTask(SideT& side, const RangeSplit& split, const size_t digit, HistogramsT& histograms,
+                        ThreadPool* pool) {
+  RunRadixTasks(pool, split.TasksCnt(), [&](const size_t task) {
+    RadixHistogram& histogram = histograms.At(task)[digit];
+    histogram.fill(0);
+    side.ForEach(split.Begin(task), split.End(task), [digit, &histogram](const auto* data, const size_t count, size_t) {
+      for (size_t i = 0; i < count; ++i) {
+        ++histogram[RadixDigit(data[i], digit)];
+      }
+    });
+  });
+}
+
+template<RadixSortableVector VectorT>
+void StableRadixSortImpl(VectorT& vector, ThreadPool* pool) {
+  using ElemT = typename VectorT::value_type;
+  static constexpr size_t DIGITS_CNT = sizeof(typename RadixKey<ElemT>::Bits);
+
+  const size_t size = vector.Size();
+  if (size <= 1) {
+    return;
+  }
+
+  PrepareSegments(vector);
+  RadixScratch<ElemT, decltype(RadixScratchAllocator(vector))> scratch(RadixScratchAllocator(vector), size);
+  auto vector_side = MakeRadixSide(vector);
+  RadixBufferSide<ElemT> buffer_side{scratch.Data()};
+
+  const RangeSplit split(size, VECTOR_GRAIN<VectorT>, pool != nullptr ? pool->ThreadsCnt() : 1);
+  auto histograms = CountDigitsByTask(vector_side, split, DIGITS_CNT, pool);
+  const auto& total = histograms.At(split.TasksCnt());
+
+  bool in_buffer = false;
+  bool counted = true;
+  for (size_t digit = 0; digit < DIGITS_CNT; ++digit) {
+    if (IsSingleBucket(total[digit], size)) {
+      continue;
+    }
+
+    if (!counted) {
+      if (in_buffer) {
+        RecountDigitByTask(buffer_side, split, digit, histograms, pool);
+      } else {
+        RecountDigitByTask(vector_side, split, digit, histograms, pool);
+      }
+    }
+    if (in_buffer) {
+      ScatterDigitByTask(buffer_side, vector_side, split, digit, histograms, pool);
+    } else {
+      ScatterDigitByTask(vector_side, buffer_side, split, digit, histograms, pool);
+    }
+    in_buffer = !in_buffer;
+    counted = split.TasksCnt() == 1;
+  }
+
+  if (in_buffer) {
+    RunRadixTasks(pool, split.TasksCnt(), [&](const size_t task) {
+      vector_side.ForEach(split.Begin(task), split.End(task), [&scratch](ElemT* data, const size_t count, const size_t offset) {
+        std::move(scratch.Data() + offset, scratch.Data() + offset + count, data);
+      });
+    });
+  }
+}
+
+template<RadixSortableVector VectorT>
+void RadixSortImpl(VectorT& vector, ThreadPool* pool) {
+  using ElemT = typename VectorT::value_type;
+  static constexpr size_t DIGITS_CNT = sizeof(typename RadixKey<ElemT>::Bits);
+  // Buckets this small are cheaper to hand to std::sort than to count.
+  static constexpr size_t SMALL_BUCKET_SIZE = 128;
+
+  auto key_less = [](const ElemT& lhs, const ElemT& rhs) {
+    return RadixBits(lhs) < RadixBits(rhs);
+  };
+
+  const size_t size = vector.Size();
+  PrepareSegments(vector);
+  if (size <= SMALL_BUCKET_SIZE) {
+    if constexpr (VectorT::IS_CONTIGUOUS) {
+      std::sort(vector.Data(), vector.Data() + size, key_less);
+    } else {
+      std::sort(vector.begin(), vector.end(), key_less);
+    }
+    return;
+  }
+
+  RadixScratch<ElemT, decltype(RadixScratchAllocator(vector))> scratch(RadixScratchAllocator(vector), size);
+  auto vector_side = MakeRadixSide(vector);
+  RadixBufferSide<ElemT> buffer_side{scratch.Data()};
+
+  const RangeSplit split(size, VECTOR_GRAIN<VectorT>, pool != nullptr ? pool->ThreadsCnt() : 1);
+  auto histograms = CountDigitsByTask(vector_side, split, DIGITS_CNT, pool);
+  const RadixHistogram* total = histograms.At(split.TasksCnt()).data();
+
+  size_t top = DIGITS_CNT;
+  while (top > 0 && IsSingleBucket(total[top - 1], size)) {
+    --top;
+  }
+  if (top == 0) {
+    return;
+  }
+  --top;
+
+  RadixHistogram bucket_begin = total[top];
+  size_t slot = 0;
+  for (size_t& bucket : bucket_begin) {
+    slot += std::exchange(bucket, slot);
+  }
+  ScatterDigitByTask(vector_side, buffer_side, split, top, histograms, pool);
+
+  RunRadixTasks(pool, RADIX, [&](const size_t bucket) {
+    const size_t begin = bucket_begin[bucket];
+    const size_t end = bucket + 1 < RADIX ? bucket_begin[bucket + 1] : size;
+    if (begin == end) {
+      return;
+    }
+
+    bool in_vector = false;
+    if (end - begin <= SMALL_BUCKET_SIZE) {
+      std::sort(scratch.Data() + begin, scratch.Data() + end, key_less);
+    } else {
+      in_vector = LsdSortRange(buffer_side, vector_side, begin, end, top);
+    }
+    if (!in_vector) {
+      vector_side.ForEach(begin, end, [&scratch](ElemT* data, const size_t count, const size_t offset) {
+        std::move(scratch.Data() + offset, scratch.Data() + offset + count, data);
+      });
+    }
+  });
+}
+
+template<RadixSortableVector VectorT>
+void StableRadixSort(VectorT& vector) {
+  StableRadixSortImpl(vector, nullptr);
+}
+
+template<RadixSortableVector VectorT>
+void StableRadixSort(VectorT& vector, ThreadPool& pool) {
+  StableRadixSortImpl(vector, &pool);
+}
+
+template<RadixSortableVector VectorT>
+void RadixSort(VectorT& vector) {
+  RadixSortImpl(vector, nullptr);
+}
+
+template<RadixSortableVector VectorT>
+void RadixSort(VectorT& vector, ThreadPool& pool) {
+  RadixSortImpl(vector, &pool);
+}
+
+#endif /* radix_sort.hpp */
@@ -0,0 +1,130 @@
+#ifndef RANK_SELECT_HPP
+#define RANK_SELECT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+
+#include "dynamic_storage.hpp"
+
+// Rank/select directory over the words of a Vector<bool>: an absolute count of set bits
+// before every 4096-bit superblock and a relative uint16_t count before every 512-bit
+// block, about 4.7% of the bits. Rank1 adds both counts to at most eight popcounts,
+// Select1 binary searches the superblocks and scans one superblock.
+
+class RankSelectIndex {
+ public:
+  using Word = uint64_t;
+
+  static constexpr size_t WORD_BITS_       = 64;
+  static constexpr size_t BLOCK_WORDS_     = 8;
+  static constexpr size_t SUPERBLOCK_WORDS_ = 64;
+  static constexpr size_t BLOCKS_PER_SUPERBLOCK_ = SUPERBLOCK_WORDS_ / BLOCK_WORDS_;
+
+ public:
+  template<typename BoolVector>
+  void Build(const BoolVector& bits) {
+    const size_t words_cnt = bits.WordsCnt();
+    blocks_.Resize(CeilDiv(words_cnt, BLOCK_WORDS_));
+    superblocks_.Resize(CeilDiv(words_cnt, SUPERBLOCK_WORDS_) + 1);
+
+    size_t word_num = 0;
+    uint64_t total = 0;
+    uint64_t in_superblock = 0;
+    bits.ForEachWordSegment([&](const Word* words, const size_t count) {
+      for (size_t i = 0; i < count; ++i, ++word_num) {
+        if (word_num % SUPERBLOCK_WORDS_ == 0) {
+          superblocks_.At(word_num / SUPERBLOCK_WORDS_) = total;
+          in_superblock = 0;
+        }
+        if (word_num % BLOCK_WORDS_ == 0) {
+          blocks_.At(word_num / BLOCK_WORDS_) = static_cast<uint16_t>(in_superblock);
+        }
+
+        const size_t ones = std::popcount(words[i]);
+        total += ones;
+        in_superblock += ones;
+      }
+    });
+    superblocks_.At(superblocks_.Size() - 1) = total;
+  }
+
+  [[nodiscard]] inline size_t Ones() const {
+    return superblocks_.Size() == 0 ? 0 : superblocks_.At(superblocks_.Size() - 1);
+  }
+
+  // Set bits in [0, index); index must not exceed the number of bits.
+  template<typename BoolVector>
+  [[nodiscard]] size_t Rank1(const BoolVector& bits, const size_t index) const {
+    const size_t word_num = index / WORD_BITS_;
+    if (word_num == bits.WordsCnt()) {
+      return Ones();
+    }
+
+    const size_t block_num = word_num / BLOCK_WORDS_;
+    size_t rank = superblocks_.At(word_num / SUPERBLOCK_WORDS_) + blocks_.At(block_num);
+    for (size_t i = block_num * BLOCK_WORDS_; i < word_num; ++i) {
+      rank += std::popcount(bits.GetWord(i));
+    }
+
+    const size_t bit = index % WORD_BITS_;
+    if (bit != 0) {
+      rank += std::popcount(bits.GetWord(word_num) << (WORD_BITS_ - bit));
+    }
+    return rank;
+  }
+
+  // Index of the set bit with rank k (zero-based); k must be less than Ones().
+  template<typename BoolVector>
+  [[nodiscard]] size_t Select1(const BoolVector& bits, size_t k) const {
+    const uint64_t* first = &superblocks_.At(0);
+    const uint64_t* last = first + superblocks_.Size() - 1;
+    const size_t superblock = std::upper_bound(first, last, k) - first - 1;
+    k -= superblocks_.At(superblock);
+
+    const size_t first_block = superblock * BLOCKS_PER_SUPERBLOCK_;
+    const size_t last_block = std::min(first_block + BLOCKS_PER_SUPERBLOCK_, blocks_.Size());
+    size_t block = first_block;
+    while (block + 1 < last_block && blocks_.At(block + 1) <= k) {
+      ++block;
+    }
+    k -= blocks_.At(block);
+
+    size_t word_num = block * BLOCK_WORDS_;
+    Word word = bits.GetWord(word_num);
+    for (size_t ones = std::popcount(word); ones <= k; ones = std::popcount(word)) {
+      k -= ones;
+      word = bits.GetWord(++word_num);
+    }
+
+    return word_num * WORD_BITS_ + SelectInWord(word, k);
+  }
+
+ private:
+  // Position of the k-th set bit of word: find the byte by popcounts, then clear lower bits.
+  static size_t SelectInWord(Word word, size_t k) {
+    size_t shift = 0;
+    for (size_t ones = std::popcount(word & 0xff); ones <= k; ones = std::popcount(word & 0xff)) {
+      k -= ones;
+      word >>= 8;
+      shift += 8;
+    }
+
+    for (; k != 0; --k) {
+      word &= word - 1;
+    }
+    return shift + std::countr_zero(word);
+  }
+
+  static constexpr size_t CeilDiv(const size_t lhs, const size_t rhs) {
+    return (lhs + rhs - 1) / rhs;
+  }
+
+ private:
+  DynamicStorage<uint64_t> superblocks_;
+  DynamicStorage<uint16_t> blocks_;
+
+};
+
+#endif /* rank_select.hpp */
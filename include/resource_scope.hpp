@@ -0,0 +1,31 @@
+#ifndef RESOURCE_SCOPE_HPP
+#define RESOURCE_SCOPE_HPP
+
+// Makes resource the current one of its type on this thread for the scope's lifetime.
+// Allocators and storages bind to the current resource when they are constructed.
+template<typename ResourceT>
+class ResourceScope {
+ public:
+  explicit ResourceScope(ResourceT& resource) : previous_{current_} {
+    current_ = &resource;
+  }
+
+  ResourceScope(const ResourceScope&) = delete;
+  ResourceScope& operator=(const ResourceScope&) = delete;
+
+  ~ResourceScope() {
+    current_ = previous_;
+  }
+
+  [[nodiscard]] static inline ResourceT* Current() {
+    return current_;
+  }
+
+ private:
+  ResourceT* previous_{nullptr};
+
+  static inline thread_local ResourceT* current_{nullptr};
+
+};
+
+#endif /* resource_scope.hpp */
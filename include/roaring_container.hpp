@@ -0,0 +1,523 @@
+#ifndef ROARING_CONTAINER_HPP
+#define ROARING_CONTAINER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <algorithm>
+
+#include "dynamic_storage.hpp"
+#include "bit_ops.hpp"
+
+// One 65536-bit block of a compressed bitmap, stored in whichever of three forms is
+// smallest: a sorted array of up to 4096 set positions, a 1024-word bitmap, or a sorted
+// list of runs kept as (start, length - 1) pairs.
+
+class RoaringContainer {
+ public:
+  using Word = uint64_t;
+
+  enum class Kind : uint8_t {
+    ARRAY,
+    BITMAP,
+    RUN
+  };
+
+  static constexpr size_t BITS_CNT_  = size_t{1} << 16;
+  static constexpr size_t WORDS_CNT_ = BITS_CNT_ / 64;
+  static constexpr size_t ARRAY_MAX_ = 4096;
+
+ public:
+  RoaringContainer() = default;
+
+  explicit RoaringContainer(const size_t key) : key_{key} {
+  }
+
+  [[nodiscard]] inline size_t Key() const noexcept {
+    return key_;
+  }
+
+  [[nodiscard]] inline Kind GetKind() const noexcept {
+    return kind_;
+  }
+
+  [[nodiscard]] inline size_t Cardinality() const noexcept {
+    return cardinality_;
+  }
+
+  [[nodiscard]] inline bool Empty() const noexcept {
+    return cardinality_ == 0;
+  }
+
+  [[nodiscard]] size_t BytesUsed() const noexcept {
+    return sizeof(RoaringContainer) + HeapBytes();
+  }
+
+  // Bytes of the value and word buffers, without the container itself.
+  [[nodiscard]] size_t HeapBytes() const noexcept {
+    return values_.Capacity() * sizeof(uint16_t) + words_.Capacity() * sizeof(Word);
+  }
+
+  [[nodiscard]] bool Contains(const size_t low) const {
+    switch (kind_) {
+      case Kind::ARRAY:
+        return std::binary_search(Values(), Values() + cardinality_, low);
+      case Kind::BITMAP:
+        return (words_.At(low >> 6) >> (low % 64)) & 0x1;
+      case Kind::RUN: {
+        const size_t run = RunBefore(low);
+        return run != RunsCnt() && RunStart(run) <= low;
+      }
+    }
+    return false;
+  }
+
+  void Add(const size_t low) {
+    if (kind_ == Kind::ARRAY) {
+      uint16_t* pos = std::lower_bound(Values(), Values() + cardinality_, low);
+      if (pos != Values() + cardinality_ && *pos == low) {
+        return;
+      }
+      if (cardinality_ < ARRAY_MAX_) {
+        InsertValue(pos - Values(), static_cast<uint16_t>(low));
+        return;
+      }
+    }
+
+    MakeBitmap();
+    Word& word = words_.At(low >> 6);
+    const Word mask = Word{1} << (low % 64);
+    cardinality_ += (word & mask) == 0;
+    word |= mask;
+  }
+
+  void Remove(const size_t low) {
+    if (kind_ == Kind::ARRAY) {
+      uint16_t* pos = std::lower_bound(Values(), Values() + cardinality_, low);
+      if (pos != Values() + cardinality_ && *pos == low) {
+        std::memmove(pos, pos + 1, (Values() + cardinality_ - pos - 1) * sizeof(uint16_t));
+        values_.Resize(--cardinality_);
+      }
+      return;
+    }
+
+    MakeBitmap();
+    Word& word = words_.At(low >> 6);
+    const Word mask = Word{1} << (low % 64);
+    cardinality_ -= (word & mask) != 0;
+    word &= ~mask;
+    if (cardinality_ <= ARRAY_MAX_) {
+      FromWords(words_.Buffer());
+    }
+  }
+
+  // Sets or clears [first, last) and re-picks the smallest form.
+  void FillRange(const size_t first, const size_t last, const bool value) {
+    Word words[WORDS_CNT_];
+    ToWords(words);
+    for (size_t i = first; i < last;) {
+      const size_t bit = i % 64;
+      const size_t cnt = std::min(last - i, 64 - bit);
+      const Word mask = (cnt == 64 ? ~Word{0} : ((Word{1} << cnt) - 1)) << bit;
+      words[i >> 6] = value ? (words[i >> 6] | mask) : (words[i >> 6] & ~mask);
+      i += cnt;
+    }
+    FromWords(words);
+  }
+
+  // First set position >= from, or BITS_CNT_.
+  [[nodiscard]] size_t NextSet(const size_t from) const {
+    if (from >= BITS_CNT_) {
+      return BITS_CNT_;
+    }
+
+    switch (kind_) {
+      case Kind::ARRAY: {
+        const uint16_t* pos = std::lower_bound(Values(), Values() + cardinality_, from);
+        return pos == Values() + cardinality_ ? BITS_CNT_ : *pos;
+      }
+      case Kind::BITMAP: {
+        size_t word_num = from >> 6;
+        Word word = words_.At(word_num) & (~Word{0} << (from % 64));
+        while (word == 0) {
+          if (++word_num == WORDS_CNT_) {
+            return BITS_CNT_;
+          }
+          word = words_.At(word_num);
+        }
+        return word_num * 64 + std::countr_zero(word);
+      }
+      case Kind::RUN: {
+        const size_t run = RunBefore(from);
+        if (run == RunsCnt()) {
+          return BITS_CNT_;
+        }
+        return std::max<size_t>(from, RunStart(run));
+      }
+    }
+    return BITS_CNT_;
+  }
+
+  // First unset position >= from, or BITS_CNT_.
+  [[nodiscard]] size_t NextUnset(const size_t from) const {
+    if (from >= BITS_CNT_) {
+      return BITS_CNT_;
+    }
+
+    switch (kind_) {
+      case Kind::ARRAY: {
+        const uint16_t* pos = std::lower_bound(Values(), Values() + cardinality_, from);
+        size_t low = from;
+        for (; pos != Values() + cardinality_ && *pos == low; ++pos) {
+          ++low;
+        }
+        return low;
+      }
+      case Kind::BITMAP: {
+        size_t word_num = from >> 6;
+        Word word = ~words_.At(word_num) & (~Word{0} << (from % 64));
+        while (word == 0) {
+          if (++word_num == WORDS_CNT_) {
+            return BITS_CNT_;
+          }
+          word = ~words_.At(word_num);
+        }
+        return word_num * 64 + std::countr_zero(word);
+      }
+      case Kind::RUN: {
+        const size_t run = RunBefore(from);
+        if (run == RunsCnt() || from < RunStart(run)) {
+          return from;
+        }
+        return RunLast(run) + 1;
+      }
+    }
+    return BITS_CNT_;
+  }
+
+  template<typename FuncT>
+  void ForEach(FuncT&& func) const {
+    switch (kind_) {
+      case Kind::ARRAY:
+        for (size_t i = 0; i < cardinality_; ++i) {
+          func(size_t{values_.At(i)});
+        }
+        break;
+      case Kind::BITMAP:
+        for (size_t i = 0; i < WORDS_CNT_; ++i) {
+          for (Word word = words_.At(i); word != 0; word &= word - 1) {
+            func(i * 64 + std::countr_zero(word));
+          }
+        }
+        break;
+      case Kind::RUN:
+        for (size_t run = 0; run < RunsCnt(); ++run) {
+          for (size_t low = RunStart(run); low <= RunLast(run); ++low) {
+            func(low);
+          }
+        }
+        break;
+    }
+  }
+
+  void ToWords(Word* words) const {
+    if (kind_ == Kind::BITMAP) {
+      std::memcpy(words, words_.Buffer(), WORDS_CNT_ * sizeof(Word));
+      return;
+    }
+
+    std::memset(words, 0, WORDS_CNT_ * sizeof(Word));
+    if (kind_ == Kind::ARRAY) {
+      for (size_t i = 0; i < cardinality_; ++i) {
+        words[values_.At(i) >> 6] |= Word{1} << (values_.At(i) % 64);
+      }
+      return;
+    }
+
+    for (size_t run = 0; run < RunsCnt(); ++run) {
+      SetRun(words, RunStart(run), RunLast(run));
+    }
+  }
+
+  // Rebuilds the container from a 1024-word bitmap, choosing the smallest form.
+  void FromWords(const Word* words) {
+    const size_t cardinality = PopcountWords(words, WORDS_CNT_);
+    const size_t runs_cnt = CountRuns(words, WORDS_CNT_);
+
+    const size_t array_bytes = cardinality * sizeof(uint16_t);
+    const size_t run_bytes = runs_cnt * 2 * sizeof(uint16_t);
+    const size_t bitmap_bytes = WORDS_CNT_ * sizeof(Word);
+
+    if (run_bytes < std::min(array_bytes, bitmap_bytes)) {
+      StoreRuns(words, runs_cnt);
+    } else if (cardinality <= ARRAY_MAX_) {
+      StoreArray(words, cardinality);
+    } else {
+      if (kind_ != Kind::BITMAP || words != words_.Buffer()) {
+        DynamicStorage<Word> bitmap;
+        bitmap.ResizeDefaultInit(WORDS_CNT_);
+        std::memcpy(bitmap.Buffer(), words, bitmap_bytes);
+        std::swap(words_, bitmap);
+        values_ = DynamicStorage<uint16_t>();
+      }
+      kind_ = Kind::BITMAP;
+    }
+    cardinality_ = cardinality;
+  }
+
+  // Applies Op to two containers of the same key. Array pairs are merged directly,
+  // everything else goes through the SIMD word kernels.
+  template<BitOp Op>
+  static RoaringContainer Combine(const RoaringContainer& lhs, const RoaringContainer& rhs) {
+    if (lhs.kind_ == Kind::ARRAY && rhs.kind_ == Kind::ARRAY) {
+      if (Op != BitOp::OR || lhs.cardinality_ + rhs.cardinality_ <= ARRAY_MAX_) {
+        return MergeArrays<Op>(lhs, rhs);
+      }
+    }
+
+    RoaringContainer result(lhs.key_);
+    if constexpr (Op == BitOp::AND || Op == BitOp::AND_NOT) {
+      if (lhs.kind_ == Kind::ARRAY) {
+        for (size_t i = 0; i < lhs.cardinality_; ++i) {
+          const uint16_t low = lhs.values_.At(i);
+          if (rhs.Contains(low) == (Op == BitOp::AND)) {
+            result.PushValue(low);
+          }
+        }
+        return result;
+      }
+    }
+    if constexpr (Op == BitOp::AND) {
+      if (rhs.kind_ == Kind::ARRAY) {
+        return Combine<Op>(rhs, lhs);
+      }
+    }
+
+    Word rhs_words[WORDS_CNT_];
+    const Word* rhs_bitmap = rhs.kind_ == Kind::BITMAP ? rhs.words_.Buffer() : rhs_words;
+    if (rhs.kind_ != Kind::BITMAP) {
+      rhs.ToWords(rhs_words);
+    }
+    result.CombineIntoBitmap<Op>(lhs, rhs_bitmap);
+    return result;
+  }
+
+  // Applies Op to a container and a block of dense words, zero-padded past words_cnt.
+  template<BitOp Op>
+  static RoaringContainer CombineDense(const RoaringContainer& lhs, const Word* dense, const size_t words_cnt) {
+    RoaringContainer result(lhs.key_);
+
+    if constexpr (Op == BitOp::AND || Op == BitOp::AND_NOT) {
+      if (lhs.kind_ == Kind::ARRAY) {
+        for (size_t i = 0; i < lhs.cardinality_; ++i) {
+          const uint16_t low = lhs.values_.At(i);
+          const bool in_dense = (low >> 6) < words_cnt && ((dense[low >> 6] >> (low % 64)) & 0x1);
+          if (in_dense == (Op == BitOp::AND)) {
+            result.PushValue(low);
+          }
+        }
+        return result;
+      }
+    }
+
+    if (words_cnt == WORDS_CNT_) {
+      result.CombineIntoBitmap<Op>(lhs, dense);
+    } else {
+      Word rhs_words[WORDS_CNT_] = {};
+      std::memcpy(rhs_words, dense, words_cnt * sizeof(Word));
+      result.CombineIntoBitmap<Op>(lhs, rhs_words);
+    }
+    return result;
+  }
+
+  // Re-picks the smallest form and drops spare capacity.
+  void Optimize() {
+    if (kind_ == Kind::BITMAP) {
+      FromWords(words_.Buffer());
+    } else if (kind_ == Kind::ARRAY) {
+      Word words[WORDS_CNT_];
+      ToWords(words);
+      FromWords(words);
+    }
+    values_.Shrink();
+  }
+
+ private:
+  inline uint16_t* Values() noexcept {
+    return values_.Buffer();
+  }
+
+  inline const uint16_t* Values() const noexcept {
+    return values_.Buffer();
+  }
+
+  inline size_t RunsCnt() const noexcept {
+    return values_.Size() / 2;
+  }
+
+  inline size_t RunStart(const size_t run) const noexcept {
+    return values_.At(2 * run);
+  }
+
+  inline size_t RunLast(const size_t run) const noexcept {
+    return RunStart(run) + values_.At(2 * run + 1);
+  }
+
+  // First run that ends at or after low.
+  size_t RunBefore(const size_t low) const {
+    size_t first = 0;
+    size_t last = RunsCnt();
+    while (first < last) {
+      const size_t mid = (first + last) / 2;
+      if (RunLast(mid) < low) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+    return first;
+  }
+
+  template<BitOp Op>
+  static RoaringContainer MergeArrays(const RoaringContainer& lhs, const RoaringContainer& rhs) {
+    RoaringContainer result(lhs.key_);
+    const uint16_t* lhs_it = lhs.Values();
+    const uint16_t* lhs_end = lhs_it + lhs.cardinality_;
+    const uint16_t* rhs_it = rhs.Values();
+    const uint16_t* rhs_end = rhs_it + rhs.cardinality_;
+
+    while (lhs_it != lhs_end && rhs_it != rhs_end) {
+      if (*lhs_it < *rhs_it) {
+        if constexpr (Op != BitOp::AND) {
+          result.PushValue(*lhs_it);
+        }
+        ++lhs_it;
+      } else if (*rhs_it < *lhs_it) {
+        if constexpr (Op == BitOp::OR || Op == BitOp::XOR) {
+          result.PushValue(*rhs_it);
+        }
+        ++rhs_it;
+      } else {
+        if constexpr (Op == BitOp::AND || Op == BitOp::OR) {
+          result.PushValue(*lhs_it);
+        }
+        ++lhs_it;
+        ++rhs_it;
+      }
+    }
+
+    if constexpr (Op != BitOp::AND) {
+      for (; lhs_it != lhs_end; ++lhs_it) {
+        result.PushValue(*lhs_it);
+      }
+    }
+    if constexpr (Op == BitOp::OR || Op == BitOp::XOR) {
+      for (; rhs_it != rhs_end; ++rhs_it) {
+        result.PushValue(*rhs_it);
+      }
+    }
+
+    if (result.cardinality_ > ARRAY_MAX_) {
+      result.Optimize();
+    }
+    return result;
+  }
+
+  // Fills this empty container with lhs Op rhs_words and re-picks the smallest form.
+  template<BitOp Op>
+  void CombineIntoBitmap(const RoaringContainer& lhs, const Word* rhs_words) {
+    words_.ResizeDefaultInit(WORDS_CNT_);
+    lhs.ToWords(words_.Buffer());
+    BitOpWords<Op>(words_.Buffer(), rhs_words, WORDS_CNT_);
+    kind_ = Kind::BITMAP;
+    FromWords(words_.Buffer());
+  }
+
+  // Sets [first, last] in a 1024-word bitmap.
+  static void SetRun(Word* words, const size_t first, const size_t last) {
+    const size_t first_word = first >> 6;
+    const size_t last_word = last >> 6;
+    const Word first_mask = ~Word{0} << (first % 64);
+    const Word last_mask = ~Word{0} >> (63 - last % 64);
+    if (first_word == last_word) {
+      words[first_word] |= first_mask & last_mask;
+      return;
+    }
+
+    words[first_word] |= first_mask;
+    std::fill(words + first_word + 1, words + last_word, ~Word{0});
+    words[last_word] |= last_mask;
+  }
+
+  void InsertValue(const size_t pos, const uint16_t value) {
+    values_.Resize(cardinality_ + 1);
+    std::memmove(Values() + pos + 1, Values() + pos, (cardinality_ - pos) * sizeof(uint16_t));
+    values_.At(pos) = value;
+    ++cardinality_;
+  }
+
+  // Appends to an array container built in increasing order.
+  void PushValue(const uint16_t value) {
+    *values_.ReserveBack() = value;
+    ++cardinality_;
+  }
+
+  void MakeBitmap() {
+    if (kind_ == Kind::BITMAP) {
+      return;
+    }
+
+    DynamicStorage<Word> bitmap(WORDS_CNT_);
+    ToWords(bitmap.Buffer());
+    std::swap(words_, bitmap);
+    values_ = DynamicStorage<uint16_t>();
+    kind_ = Kind::BITMAP;
+  }
+
+  void StoreArray(const Word* words, const size_t cardinality) {
+    DynamicStorage<uint16_t> values(cardinality);
+    size_t pos = 0;
+    for (size_t i = 0; i < WORDS_CNT_; ++i) {
+      for (Word word = words[i]; word != 0; word &= word - 1) {
+        values.At(pos++) = static_cast<uint16_t>(i * 64 + std::countr_zero(word));
+      }
+    }
+    std::swap(values_, values);
+    words_ = DynamicStorage<Word>();
+    kind_ = Kind::ARRAY;
+  }
+
+  void StoreRuns(const Word* words, const size_t runs_cnt) {
+    DynamicStorage<uint16_t> values(2 * runs_cnt);
+    size_t pos = 0;
+    size_t low = 0;
+    while (pos < 2 * runs_cnt) {
+      while (!((words[low >> 6] >> (low % 64)) & 0x1)) {
+        const Word rest = words[low >> 6] >> (low % 64);
+        low = rest == 0 ? (low | 63) + 1 : low + std::countr_zero(rest);
+      }
+      size_t end = low;
+      while (end < BITS_CNT_ && ((words[end >> 6] >> (end % 64)) & 0x1)) {
+        const Word rest = ~words[end >> 6] >> (end % 64);
+        end = rest == 0 ? (end | 63) + 1 : end + std::countr_zero(rest);
+      }
+      values.At(pos++) = static_cast<uint16_t>(low);
+      values.At(pos++) = static_cast<uint16_t>(end - low - 1);
+      low = end;
+    }
+    std::swap(values_, values);
+    words_ = DynamicStorage<Word>();
+    kind_ = Kind::RUN;
+  }
+
+ private:
+  size_t key_{0};
+  Kind kind_{Kind::ARRAY};
+  size_t cardinality_{0};
+  DynamicStorage<uint16_t> values_;
+  DynamicStorage<Word> words_;
+
+};
+
+#endif /* roaring_container.hpp */
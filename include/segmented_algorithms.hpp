@@ -0,0 +1,208 @@
+#ifndef SEGMENTED_ALGORITHMS_HPP
+#define SEGMENTED_ALGORITHMS_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include "vector.hpp"
+#include "simd_kernels.hpp"
+#include "simd_search.hpp"
+
+// Algorithms over Vector that run a plain loop over every contiguous segment of the storage
+// instead of stepping through BaseVectorIterator.
+
+template<typename VectorT, typename FuncT>
+void ForEach(VectorT& vector, FuncT&& func) {
+  vector.ForEachSegment([&func](auto* data, const size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      func(data[i]);
+    }
+  });
+}
+
+template<typename VectorT, typename OutputIt>
+OutputIt Copy(const VectorT& vector, OutputIt out) {
+  vector.ForEachSegment([&out](const auto* data, const size_t count) {
+    out = std::copy(data, data + count, out);
+  });
+  return out;
+}
+
+template<typename VectorT, typename ValueT>
+void Fill(VectorT& vector, const ValueT& value) {
+  using ElemT = typename VectorT::value_type;
+
+  vector.ForEachSegment([&value](ElemT* data, const size_t count) {
+    if constexpr (SimdArithmetic<ElemT>) {
+      SimdFill(data, count, static_cast<ElemT>(value));
+    } else {
+      std::fill(data, data + count, value);
+    }
+  });
+}
+
+// Whether pred can run through the SIMD search kernels for the elements of VectorT. Each
+// algorithm still asks PlanSearch whether this particular value can.
+template<typename VectorT, typename PredT>
+inline constexpr bool SIMD_PREDICATE = IsCompare<PredT>::value && SimdArithmetic<typename VectorT::value_type>;
+
+// Returns the index of the first element satisfying pred, or Size() if there is none.
+template<typename VectorT, typename PredT>
+size_t FindIf(const VectorT& vector, const PredT& pred) {
+  using ElemT = typename VectorT::value_type;
+
+  const SearchPlan plan = PlanSearch<ElemT>(pred);
+  if (plan == SearchPlan::NONE) {
+    return vector.Size();
+  }
+  if (plan == SearchPlan::ALL) {
+    return 0;
+  }
+
+  size_t index = 0;
+  vector.ForEachSegment([&index, &pred, plan](const ElemT* data, const size_t count) {
+    size_t found = count;
+    if constexpr (SIMD_PREDICATE<VectorT, PredT>) {
+      if (plan == SearchPlan::KERNEL) {
+        found = SimdFind<PredT::OP>(data, count, static_cast<ElemT>(pred.value));
+      }
+    }
+    if (plan == SearchPlan::SCALAR) {
+      found = std::find_if(data, data + count, pred) - data;
+    }
+    index += found;
+    return found == count;
+  });
+  return index;
+}
+
+// Returns the index of the first element equal to value, or Size() if there is none.
+template<typename VectorT, typename ValueT>
+size_t Find(const VectorT& vector, const ValueT& value) {
+  return FindIf(vector, Equal(value));
+}
+
+template<typename VectorT, typename PredT>
+size_t CountIf(const VectorT& vector, const PredT& pred) {
+  using ElemT = typename VectorT::value_type;
+
+  const SearchPlan plan = PlanSearch<ElemT>(pred);
+  if (plan == SearchPlan::NONE) {
+    return 0;
+  }
+  if (plan == SearchPlan::ALL) {
+    return vector.Size();
+  }
+
+  size_t matches = 0;
+  vector.ForEachSegment([&matches, &pred, plan](const ElemT* data, const size_t count) {
+    if constexpr (SIMD_PREDICATE<VectorT, PredT>) {
+      if (plan == SearchPlan::KERNEL) {
+        matches += SimdCount<PredT::OP>(data, count, static_cast<ElemT>(pred.value));
+      }
+    }
+    if (plan == SearchPlan::SCALAR) {
+      matches += std::count_if(data, data + count, pred);
+    }
+  });
+  return matches;
+}
+
+template<typename VectorT, typename ValueT>
+size_t Count(const VectorT& vector, const ValueT& value) {
+  return CountIf(vector, Equal(value));
+}
+
+// Moves the elements for which pred(elem) == Keep to the front, in order, and returns their
+// count. Each segment is compacted in place first; segments after the first then shift their
+// survivors down behind the ones already kept.
+template<bool Keep, typename VectorT, typename PredT>
+size_t CompactSegments(VectorT& vector, const PredT& pred) {
+  using ElemT = typename VectorT::value_type;
+
+  const SearchPlan plan = PlanSearch<ElemT>(pred);
+  if (plan == SearchPlan::NONE || plan == SearchPlan::ALL) {
+    return (plan == SearchPlan::ALL) == Keep ? vector.Size() : 0;
+  }
+
+  size_t out = 0;
+  size_t offset = 0;
+  vector.ForEachSegment([&](ElemT* data, const size_t count) {
+    size_t kept = count;
+    if constexpr (SIMD_PREDICATE<VectorT, PredT>) {
+      if (plan == SearchPlan::KERNEL) {
+        kept = SimdCompact<PredT::OP, Keep>(data, count, static_cast<ElemT>(pred.value));
+      }
+    }
+    if (plan == SearchPlan::SCALAR) {
+      kept = std::remove_if(data, data + count, [&pred](const ElemT& elem) {
+        return static_cast<bool>(pred(elem)) != Keep;
+      }) - data;
+    }
+
+    if (out != offset) {
+      for (size_t i = 0; i < kept; ++i) {
+        vector.At(out + i) = std::move(data[i]);
+      }
+    }
+    out += kept;
+    offset += count;
+  });
+  return out;
+}
+
+template<typename VectorT>
+void TruncateTo(VectorT& vector, const size_t size) {
+  if constexpr (SimdArithmetic<typename VectorT::value_type>) {
+    vector.Resize(size);
+  } else {
+    vector.Erase(vector.cbegin() + size, vector.cend());
+  }
+}
+
+// Keeps only the elements satisfying pred, in order, and returns the new size.
+template<typename VectorT, typename PredT>
+size_t Compact(VectorT& vector, const PredT& pred) {
+  const size_t kept = CompactSegments<true>(vector, pred);
+  TruncateTo(vector, kept);
+  return kept;
+}
+
+// Removes the elements satisfying pred, in order, and returns how many were removed.
+template<typename VectorT, typename PredT>
+size_t EraseIf(VectorT& vector, const PredT& pred) {
+  const size_t size = vector.Size();
+  TruncateTo(vector, CompactSegments<false>(vector, pred));
+  return size - vector.Size();
+}
+
+// Stable partition: elements satisfying pred first, then the rest. Returns the first index
+// of the second group. A single pass moves each kept element down behind the ones before it
+// and each rejected one out into a buffer, which is then moved back in behind the kept ones.
+template<typename VectorT, typename PredT>
+size_t Partition(VectorT& vector, const PredT& pred) {
+  using ElemT = typename VectorT::value_type;
+
+  Vector<ElemT> rejected;
+  rejected.Reserve(vector.Size());
+  size_t kept = 0;
+  size_t offset = 0;
+  vector.ForEachSegment([&](ElemT* data, const size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      if (!pred(data[i])) {
+        rejected.PushBack(std::move(data[i]));
+      } else {
+        if (kept != offset + i) {
+          vector.At(kept) = std::move(data[i]);
+        }
+        ++kept;
+      }
+    }
+    offset += count;
+  });
+
+  TruncateTo(vector, kept);
+  vector.Append(std::make_move_iterator(rejected.begin()), std::make_move_iterator(rejected.end()));
+  return kept;
+}
+
+#endif /* segmented_algorithms.hpp */
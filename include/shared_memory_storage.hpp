@@ -0,0 +1,304 @@
+#ifndef SHARED_MEMORY_STORAGE_HPP
+#define SHARED_MEMORY_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include "mapped_region.hpp"
+#include "offset_ptr.hpp"
+#include "object_helpers.hpp"
+#include "error_msgs.hpp"
+
+enum class SharedMode {
+  Create,
+  Attach
+};
+
+// Start of every shared segment. Only the writer stores to it; bytes is published before
+// any size that needs it, so a reader that loads size first always maps enough.
+template<typename ElemT>
+struct SharedVectorHeader {
+  static constexpr uint64_t MAGIC = 0x31484d5343455656ull; // "VVECSMH1"
+  static constexpr uint32_t VERSION = 1;
+
+  uint64_t magic{MAGIC};
+  uint32_t version{VERSION};
+  uint32_t elem_size{sizeof(ElemT)};
+  uint32_t elem_align{alignof(ElemT)};
+  uint32_t reserved{0};
+  std::atomic<uint64_t> size{0};
+  std::atomic<uint64_t> bytes{0};
+  OffsetPtr<ElemT> elements;
+};
+
+// Keeps elements in a POSIX shared memory object (shm_open) or an anonymous memfd, for
+// one writer and any number of readers in other processes. Readers attach in O(1) by
+// mapping the segment read-only at whatever address they get; elements that point at each
+// other must do so with OffsetPtr. The writer grows the segment in place and makes its
+// elements visible with Publish(); a reader sees the size of its last Refresh().
+// Vector<Point, SharedMemoryStorage> table(IN_PLACE_STORAGE, "/points", SharedMode::Create);
+template<typename ElemT, size_t N = 0>
+class SharedMemoryStorage {
+  static_assert(std::is_trivially_destructible_v<ElemT>, "SharedMemoryStorage never runs destructors");
+  static_assert(alignof(ElemT) <= 4096, "SharedMemoryStorage elements must fit the page alignment");
+
+ public:
+  using Header = SharedVectorHeader<ElemT>;
+
+  static constexpr size_t HEADER_BYTES_ = (sizeof(Header) + alignof(ElemT) - 1) / alignof(ElemT) * alignof(ElemT);
+
+ public:
+  // Anonymous segments: pass File() to the readers, e.g. across fork or over a socket.
+  SharedMemoryStorage() {
+    CreateSegment(MakeMemfd(), 0);
+  }
+
+  SharedMemoryStorage(const size_t size) {
+    CreateSegment(MakeMemfd(), size);
+    std::uninitialized_value_construct_n(buffer_, size);
+    size_ = size;
+    Publish();
+  }
+
+  SharedMemoryStorage(const size_t size, const ElemT& value) {
+    CreateSegment(MakeMemfd(), size);
+    std::uninitialized_fill_n(buffer_, size, value);
+    size_ = size;
+    Publish();
+  }
+
+  // Create fails if an object with this name already exists; remove it with Unlink.
+  SharedMemoryStorage(const char* name, const SharedMode mode) {
+    if (mode == SharedMode::Create) {
+      FileDescriptor file(shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600));
+      if (!file.IsOpen()) {
+        ThrowErrno(name);
+      }
+      CreateSegment(std::move(file), 0);
+    } else {
+      FileDescriptor file(shm_open(name, O_RDONLY, 0));
+      if (!file.IsOpen()) {
+        ThrowErrno(name);
+      }
+      AttachSegment(std::move(file));
+    }
+  }
+
+  // Attaches for reading to the segment behind file, typically another storage's File().
+  explicit SharedMemoryStorage(FileDescriptor file) {
+    AttachSegment(std::move(file));
+  }
+
+  SharedMemoryStorage(const SharedMemoryStorage&) = delete;
+  SharedMemoryStorage& operator=(const SharedMemoryStorage&) = delete;
+
+  SharedMemoryStorage(SharedMemoryStorage&& other_move) {
+    this->SwapFields(other_move);
+  }
+
+  SharedMemoryStorage& operator=(SharedMemoryStorage&& other_move) {
+    this->SwapFields(other_move);
+    return *this;
+  }
+
+  ~SharedMemoryStorage() = default;
+
+  static void Unlink(const char* name) {
+    if (shm_unlink(name) != 0 && errno != ENOENT) {
+      ThrowErrno(name);
+    }
+  }
+
+  [[nodiscard]] inline size_t Size() const {
+    return size_;
+  }
+
+  [[nodiscard]] inline size_t Capacity() const {
+    return capacity_;
+  }
+
+  [[nodiscard]] inline ElemT& At(const size_t index) {
+    return buffer_[index];
+  }
+
+  [[nodiscard]] inline const ElemT& At(const size_t index) const {
+    return buffer_[index];
+  }
+
+  void Resize(const size_t new_size) {
+    if (new_size > size_) {
+      Reserve(new_size);
+      std::uninitialized_value_construct(buffer_ + size_, buffer_ + new_size);
+    }
+    size_ = new_size;
+  }
+
+  void ResizeDefaultInit(const size_t new_size) {
+    Reserve(new_size);
+    size_ = new_size;
+  }
+
+  ElemT* ReserveBack() {
+    return ReserveBack(1);
+  }
+
+  void RollBackReservedBack() {
+    --size_;
+  }
+
+  ElemT* ReserveBack(const size_t count) {
+    if (size_ + count > capacity_) {
+      Grow(std::max(size_ + count, 2 * capacity_));
+    }
+    size_ += count;
+    return buffer_ + size_ - count;
+  }
+
+  void RollBackReservedBack(const size_t count) {
+    size_ -= count;
+  }
+
+  void Reserve(const size_t capacity) {
+    if (capacity > capacity_) {
+      Grow(capacity);
+    }
+  }
+
+  // Readers may still map the tail, so the segment is never truncated.
+  void Shrink() {
+  }
+
+  [[nodiscard]] inline ElemT* Buffer() {
+    return buffer_;
+  }
+
+  [[nodiscard]] inline const ElemT* Buffer() const {
+    return buffer_;
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    return size_ == 0 || CallSegment(func, buffer_, size_);
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return size_ == 0 || CallSegment(func, static_cast<const ElemT*>(buffer_), size_);
+  }
+
+  // Makes every element written so far visible to readers. Writer only.
+  void Publish() {
+    header_->size.store(size_, std::memory_order_release);
+  }
+
+  // Picks up the writer's last Publish, remapping if the segment has grown since. Reader only.
+  void Refresh() {
+    const size_t size = header_->size.load(std::memory_order_acquire);
+    const size_t bytes = header_->bytes.load(std::memory_order_acquire);
+    if (bytes > region_.Bytes()) {
+      region_.Remap(bytes);
+      UpdatePointers();
+    }
+    size_ = size;
+    capacity_ = size;
+  }
+
+  [[nodiscard]] inline bool IsWriter() const {
+    return writer_;
+  }
+
+  [[nodiscard]] inline const FileDescriptor& File() const {
+    return region_.File();
+  }
+
+ private:
+  static FileDescriptor MakeMemfd() {
+    FileDescriptor file(memfd_create("shared_vector", MFD_CLOEXEC));
+    if (!file.IsOpen()) {
+      ThrowErrno("memfd_create");
+    }
+    return file;
+  }
+
+  static size_t BytesFor(const size_t capacity) {
+    return RoundUpToPages(HEADER_BYTES_ + std::max<size_t>(capacity, 1) * sizeof(ElemT));
+  }
+
+  void CreateSegment(FileDescriptor file, const size_t capacity) {
+    const size_t bytes = BytesFor(capacity);
+    file.Truncate(bytes);
+    region_ = MappedRegion(std::move(file), bytes);
+    header_ = new (region_.Data()) Header;
+    header_->elements = reinterpret_cast<ElemT*>(static_cast<unsigned char*>(region_.Data()) + HEADER_BYTES_);
+    header_->bytes.store(bytes, std::memory_order_release);
+    writer_ = true;
+    UpdatePointers();
+  }
+
+  // Maps the segment as it is now and checks the header; the elements are not read.
+  void AttachSegment(FileDescriptor file) {
+    const size_t file_bytes = file.FileBytes();
+    if (file_bytes < HEADER_BYTES_) {
+      throw std::runtime_error(BAD_MMAP_HEADER_MSG);
+    }
+    region_ = MappedRegion(std::move(file), file_bytes, false);
+    header_ = static_cast<Header*>(region_.Data());
+    if (header_->magic != Header::MAGIC || header_->version != Header::VERSION ||
+        header_->elem_size != sizeof(ElemT) || header_->elem_align != alignof(ElemT)) {
+      throw std::runtime_error(BAD_MMAP_HEADER_MSG);
+    }
+    writer_ = false;
+    UpdatePointers();
+    Refresh();
+  }
+
+  void Grow(const size_t capacity) {
+    if (!writer_) {
+      throw std::logic_error(BAD_SHARED_WRITE_MSG);
+    }
+    if (header_ == nullptr) {
+      CreateSegment(MakeMemfd(), capacity);
+      return;
+    }
+    const size_t bytes = BytesFor(capacity);
+    region_.Resize(bytes);
+    UpdatePointers();
+    header_->bytes.store(bytes, std::memory_order_release);
+  }
+
+  void UpdatePointers() {
+    header_ = static_cast<Header*>(region_.Data());
+    buffer_ = header_->elements.Get();
+    if (writer_) {
+      capacity_ = (region_.Bytes() - HEADER_BYTES_) / sizeof(ElemT);
+    }
+  }
+
+  void SwapFields(SharedMemoryStorage& other) {
+    std::swap(region_, other.region_);
+    std::swap(header_, other.header_);
+    std::swap(buffer_, other.buffer_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(writer_, other.writer_);
+  }
+
+ private:
+  MappedRegion region_;
+
+  Header* header_{nullptr};
+  ElemT* buffer_{nullptr};
+
+  size_t size_{0};
+  size_t capacity_{0};
+
+  bool writer_{true};
+
+};
+
+#endif /* shared_memory_storage.hpp */
@@ -0,0 +1,248 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "cpu_features.hpp"
+
+// Arithmetic kernels over one contiguous segment. Each kernel body is written once with
+// GCC vector extensions and instantiated for 16-byte (SSE2) and 32-byte (AVX2) lanes; the
+// AVX2 copy is compiled under target("avx2") and picked at runtime. Reductions keep
+// several independent accumulators, so float sums may differ from a sequential loop in
+// the last bits.
+
+template<typename ElemT>
+concept SimdArithmetic = std::is_arithmetic_v<ElemT> && !std::is_same_v<ElemT, bool>;
+
+template<typename ElemT>
+using MinMaxPair = std::pair<ElemT, ElemT>;
+
+#define SIMD_KERNEL_INLINE inline __attribute__((always_inline))
+
+// Lane helpers and kernels are always inlined into the per-target wrappers below, so the
+// vector calling convention GCC warns about never reaches an actual call.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+template<typename ElemT, size_t Bytes>
+struct SimdLane {
+  typedef ElemT Type __attribute__((vector_size(Bytes), aligned(alignof(ElemT))));
+  // Signed integer lanes of the element width, all ones where a comparison holds.
+  using Mask = decltype(Type{} == Type{});
+
+  static constexpr size_t COUNT = Bytes / sizeof(ElemT);
+
+  static SIMD_KERNEL_INLINE Type Load(const ElemT* data) {
+    Type lane;
+    __builtin_memcpy(&lane, data, sizeof(Type));
+    return lane;
+  }
+
+  static SIMD_KERNEL_INLINE void Store(ElemT* data, const Type& lane) {
+    __builtin_memcpy(data, &lane, sizeof(Type));
+  }
+
+  static SIMD_KERNEL_INLINE Type Broadcast(const ElemT value) {
+    Type lane;
+    for (size_t i = 0; i < COUNT; ++i) {
+      lane[i] = value;
+    }
+    return lane;
+  }
+
+};
+
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE ElemT SumKernel(const ElemT* data, const size_t count) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  typename Lane::Type acc0 = Lane::Broadcast(0);
+  typename Lane::Type acc1 = acc0;
+
+  size_t i = 0;
+  for (; i + 2 * Lane::COUNT <= count; i += 2 * Lane::COUNT) {
+    acc0 += Lane::Load(data + i);
+    acc1 += Lane::Load(data + i + Lane::COUNT);
+  }
+  acc0 += acc1;
+
+  ElemT sum = 0;
+  for (size_t j = 0; j < Lane::COUNT; ++j) {
+    sum += acc0[j];
+  }
+  for (; i < count; ++i) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+// count must be positive.
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE MinMaxPair<ElemT> MinMaxKernel(const ElemT* data, const size_t count) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  ElemT min = data[0];
+  ElemT max = data[0];
+
+  size_t i = 0;
+  if (count >= Lane::COUNT) {
+    typename Lane::Type lane_min = Lane::Load(data);
+    typename Lane::Type lane_max = lane_min;
+    for (i = Lane::COUNT; i + Lane::COUNT <= count; i += Lane::COUNT) {
+      const typename Lane::Type lane = Lane::Load(data + i);
+      lane_min = lane < lane_min ? lane : lane_min;
+      lane_max = lane > lane_max ? lane : lane_max;
+    }
+    for (size_t j = 0; j < Lane::COUNT; ++j) {
+      min = lane_min[j] < min ? lane_min[j] : min;
+      max = lane_max[j] > max ? lane_max[j] : max;
+    }
+  }
+  for (; i < count; ++i) {
+    min = data[i] < min ? data[i] : min;
+    max = data[i] > max ? data[i] : max;
+  }
+  return {min, max};
+}
+
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE ElemT DotKernel(const ElemT* lhs, const ElemT* rhs, const size_t count) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  typename Lane::Type acc0 = Lane::Broadcast(0);
+  typename Lane::Type acc1 = acc0;
+
+  size_t i = 0;
+  for (; i + 2 * Lane::COUNT <= count; i += 2 * Lane::COUNT) {
+    acc0 += Lane::Load(lhs + i) * Lane::Load(rhs + i);
+    acc1 += Lane::Load(lhs + i + Lane::COUNT) * Lane::Load(rhs + i + Lane::COUNT);
+  }
+  acc0 += acc1;
+
+  ElemT dot = 0;
+  for (size_t j = 0; j < Lane::COUNT; ++j) {
+    dot += acc0[j];
+  }
+  for (; i < count; ++i) {
+    dot += lhs[i] * rhs[i];
+  }
+  return dot;
+}
+
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE void FillKernel(ElemT* data, const size_t count, const ElemT value) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  const typename Lane::Type lane = Lane::Broadcast(value);
+
+  size_t i = 0;
+  for (; i + Lane::COUNT <= count; i += Lane::COUNT) {
+    Lane::Store(data + i, lane);
+  }
+  for (; i < count; ++i) {
+    data[i] = value;
+  }
+}
+
+// dst = dst * factor
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE void ScaleKernel(ElemT* dst, const size_t count, const ElemT factor) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  const typename Lane::Type lane_factor = Lane::Broadcast(factor);
+
+  size_t i = 0;
+  for (; i + Lane::COUNT <= count; i += Lane::COUNT) {
+    Lane::Store(dst + i, Lane::Load(dst + i) * lane_factor);
+  }
+  for (; i < count; ++i) {
+    dst[i] *= factor;
+  }
+}
+
+// dst = dst + factor * src
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE void AxpyKernel(ElemT* dst, const ElemT* src, const size_t count, const ElemT factor) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  const typename Lane::Type lane_factor = Lane::Broadcast(factor);
+
+  size_t i = 0;
+  for (; i + Lane::COUNT <= count; i += Lane::COUNT) {
+    Lane::Store(dst + i, Lane::Load(dst + i) + lane_factor * Lane::Load(src + i));
+  }
+  for (; i < count; ++i) {
+    dst[i] += factor * src[i];
+  }
+}
+
+// dst = dst + src
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE void AddKernel(ElemT* dst, const ElemT* src, const size_t count) {
+  using Lane = SimdLane<ElemT, Bytes>;
+
+  size_t i = 0;
+  for (; i + Lane::COUNT <= count; i += Lane::COUNT) {
+    Lane::Store(dst + i, Lane::Load(dst + i) + Lane::Load(src + i));
+  }
+  for (; i < count; ++i) {
+    dst[i] += src[i];
+  }
+}
+
+// dst = dst * src
+template<typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE void MulKernel(ElemT* dst, const ElemT* src, const size_t count) {
+  using Lane = SimdLane<ElemT, Bytes>;
+
+  size_t i = 0;
+  for (; i + Lane::COUNT <= count; i += Lane::COUNT) {
+    Lane::Store(dst + i, Lane::Load(dst + i) * Lane::Load(src + i));
+  }
+  for (; i < count; ++i) {
+    dst[i] *= src[i];
+  }
+}
+
+// Declares Name<ElemT>(args...) that forwards to NameKernel with the widest lanes the CPU has.
+#if VECTOR_X86_SIMD
+#define SIMD_DISPATCH(Ret, Name, Params, Args)                                               \
+  template<typename ElemT>                                                                   \
+  Ret Name##Sse2 Params {                                                                    \
+    return Name##Kernel<ElemT, 16> Args;                                                     \
+  }                                                                                          \
+                                                                                             \
+  template<typename ElemT>                                                                   \
+  __attribute__((target("avx2"))) Ret Name##Avx2 Params {                                    \
+    return Name##Kernel<ElemT, 32> Args;                                                     \
+  }                                                                                          \
+                                                                                             \
+  template<typename ElemT>                                                                   \
+  inline Ret Simd##Name Params {                                                             \
+    static const auto kernel = CpuFeatures::Get().avx2 ? Name##Avx2<ElemT> : Name##Sse2<ElemT>; \
+    return kernel Args;                                                                      \
+  }
+#else
+#define SIMD_DISPATCH(Ret, Name, Params, Args)                                               \
+  template<typename ElemT>                                                                   \
+  inline Ret Simd##Name Params {                                                             \
+    return Name##Kernel<ElemT, 16> Args;                                                     \
+  }
+#endif
+
+SIMD_DISPATCH(ElemT, Sum, (const ElemT* data, const size_t count), (data, count))
+SIMD_DISPATCH(MinMaxPair<ElemT>, MinMax, (const ElemT* data, const size_t count), (data, count))
+SIMD_DISPATCH(ElemT, Dot, (const ElemT* lhs, const ElemT* rhs, const size_t count), (lhs, rhs, count))
+SIMD_DISPATCH(void, Fill, (ElemT* data, const size_t count, const ElemT value), (data, count, value))
+SIMD_DISPATCH(void, Scale, (ElemT* dst, const size_t count, const ElemT factor), (dst, count, factor))
+SIMD_DISPATCH(void, Axpy, (ElemT* dst, const ElemT* src, const size_t count, const ElemT factor),
+              (dst, src, count, factor))
+SIMD_DISPATCH(void, Add, (ElemT* dst, const ElemT* src, const size_t count), (dst, src, count))
+SIMD_DISPATCH(void, Mul, (ElemT* dst, const ElemT* src, const size_t count), (dst, src, count))
+
+#undef SIMD_DISPATCH
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif /* simd_kernels.hpp */
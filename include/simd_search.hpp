@@ -0,0 +1,463 @@
+#ifndef SIMD_SEARCH_HPP
+#define SIMD_SEARCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <bit>
+#include <limits>
+#include <type_traits>
+
+#include "simd_kernels.hpp"
+
+// Comparison predicates that search and compaction kernels can evaluate a lane at a time.
+// Any other predicate still works with the algorithms, through a scalar loop.
+
+enum class CmpOp {
+  EQ,
+  NE,
+  LT,
+  LE,
+  GT,
+  GE
+};
+
+// Compares lhs and rhs by their mathematical values: a negative signed integer is less than
+// any unsigned one instead of wrapping around in the common type.
+template<CmpOp Op, typename LhsT, typename RhsT>
+constexpr bool CompareValues(const LhsT& lhs, const RhsT& rhs) {
+  if constexpr (std::is_integral_v<LhsT> && std::is_integral_v<RhsT> &&
+                std::is_signed_v<LhsT> != std::is_signed_v<RhsT>) {
+    if constexpr (std::is_signed_v<LhsT>) {
+      if (lhs < 0) {
+        return CompareValues<Op>(0, 1);
+      }
+    } else {
+      if (rhs < 0) {
+        return CompareValues<Op>(1, 0);
+      }
+    }
+    using UnsignedT = std::make_unsigned_t<std::common_type_t<LhsT, RhsT>>;
+    return CompareValues<Op>(static_cast<UnsignedT>(lhs), static_cast<UnsignedT>(rhs));
+  } else if constexpr (Op == CmpOp::EQ) {
+    return lhs == rhs;
+  } else if constexpr (Op == CmpOp::NE) {
+    return lhs != rhs;
+  } else if constexpr (Op == CmpOp::LT) {
+    return lhs < rhs;
+  } else if constexpr (Op == CmpOp::LE) {
+    return lhs <= rhs;
+  } else if constexpr (Op == CmpOp::GT) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+template<CmpOp Op, typename ValueT>
+struct Compare {
+  static constexpr CmpOp OP = Op;
+
+  ValueT value;
+
+  // elem and value are compared as they are, so 300 never equals a uint8_t and 2.5 never
+  // equals an int.
+  template<typename ElemT>
+  inline bool operator()(const ElemT& elem) const {
+    return CompareValues<Op>(elem, value);
+  }
+
+};
+
+template<typename ValueT> inline Compare<CmpOp::EQ, ValueT> Equal(const ValueT& value)        { return {value}; }
+template<typename ValueT> inline Compare<CmpOp::NE, ValueT> NotEqual(const ValueT& value)     { return {value}; }
+template<typename ValueT> inline Compare<CmpOp::LT, ValueT> Less(const ValueT& value)         { return {value}; }
+template<typename ValueT> inline Compare<CmpOp::LE, ValueT> LessEqual(const ValueT& value)    { return {value}; }
+template<typename ValueT> inline Compare<CmpOp::GT, ValueT> Greater(const ValueT& value)      { return {value}; }
+template<typename ValueT> inline Compare<CmpOp::GE, ValueT> GreaterEqual(const ValueT& value) { return {value}; }
+
+template<typename PredT>
+struct IsCompare : std::false_type {};
+
+template<CmpOp Op, typename ValueT>
+struct IsCompare<Compare<Op, ValueT>> : std::true_type {};
+
+// Where a search value lies among the values of ElemT.
+enum class ValueFit {
+  EXACT,   // converts to ElemT and back unchanged
+  BELOW,   // less than every finite ElemT
+  ABOVE,   // greater than every finite ElemT
+  INEXACT  // within range, but fractional, rounded by the conversion or NaN
+};
+
+template<typename ElemT, typename ValueT>
+constexpr ValueFit FitValue(const ValueT& value) {
+  using Limits = std::numeric_limits<ElemT>;
+  if constexpr (std::is_integral_v<ElemT> && std::is_integral_v<ValueT>) {
+    if (CompareValues<CmpOp::LT>(value, Limits::min())) {
+      return ValueFit::BELOW;
+    }
+    if (CompareValues<CmpOp::GT>(value, Limits::max())) {
+      return ValueFit::ABOVE;
+    }
+    return ValueFit::EXACT;
+  } else if constexpr (std::is_integral_v<ElemT>) {
+    // Both bounds are zero or powers of two, so ValueT holds them exactly.
+    const ValueT lower = static_cast<ValueT>(Limits::min());
+    const ValueT upper = static_cast<ValueT>(Limits::max() / 2 + 1) * 2;
+    if (value != value) {
+      return ValueFit::INEXACT;
+    }
+    if (value < lower) {
+      return ValueFit::BELOW;
+    }
+    if (value >= upper) {
+      return ValueFit::ABOVE;
+    }
+    return static_cast<ValueT>(static_cast<ElemT>(value)) == value ? ValueFit::EXACT : ValueFit::INEXACT;
+  } else if constexpr (std::is_integral_v<ValueT>) {
+    // The common type is ElemT itself, so the kernels round the value just as a scalar
+    // comparison would.
+    return ValueFit::EXACT;
+  } else {
+    if (value != value) {
+      return ValueFit::INEXACT;
+    }
+    if (value == std::numeric_limits<ValueT>::infinity() || value == -std::numeric_limits<ValueT>::infinity()) {
+      return ValueFit::EXACT;
+    }
+    if (value < Limits::lowest()) {
+      return ValueFit::BELOW;
+    }
+    if (value > Limits::max()) {
+      return ValueFit::ABOVE;
+    }
+    return static_cast<ValueT>(static_cast<ElemT>(value)) == value ? ValueFit::EXACT : ValueFit::INEXACT;
+  }
+}
+
+// How an algorithm answers pred over elements of ElemT: through the SIMD kernels, by a
+// scalar loop, or with the same answer for every element.
+enum class SearchPlan {
+  KERNEL,
+  SCALAR,
+  ALL,
+  NONE
+};
+
+// The kernels compare against the value converted to ElemT, which only gives the right
+// answer when the conversion is exact. A value no ElemT can equal matches nothing under EQ
+// and everything under NE; one outside the range of an integer ElemT also orders the same
+// way against every element. Floating point elements may be NaN, which orders against
+// nothing, so those still take the scalar loop.
+template<typename ElemT, typename PredT>
+constexpr SearchPlan PlanSearch(const PredT& pred) {
+  if constexpr (!IsCompare<PredT>::value || !SimdArithmetic<ElemT>) {
+    return SearchPlan::SCALAR;
+  } else {
+    constexpr CmpOp OP = PredT::OP;
+    const ValueFit fit = FitValue<ElemT>(pred.value);
+    if (fit == ValueFit::EXACT) {
+      return SearchPlan::KERNEL;
+    }
+    if constexpr (OP == CmpOp::EQ) {
+      return SearchPlan::NONE;
+    } else if constexpr (OP == CmpOp::NE) {
+      return SearchPlan::ALL;
+    } else if constexpr (std::is_integral_v<ElemT>) {
+      if (fit == ValueFit::INEXACT) {
+        return SearchPlan::SCALAR;
+      }
+      const bool below_value = fit == ValueFit::ABOVE;
+      const bool less = OP == CmpOp::LT || OP == CmpOp::LE;
+      return below_value == less ? SearchPlan::ALL : SearchPlan::NONE;
+    } else {
+      return SearchPlan::SCALAR;
+    }
+  }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// Writes through mask rather than returning it: a by-value 32-byte vector return changes
+// the ABI outside of AVX code and GCC warns at every instantiation.
+template<CmpOp Op, typename Lane>
+SIMD_KERNEL_INLINE void CompareLane(typename Lane::Mask& mask, const typename Lane::Type& lane,
+                                    const typename Lane::Type& value) {
+  if constexpr (Op == CmpOp::EQ) {
+    mask = lane == value;
+  } else if constexpr (Op == CmpOp::NE) {
+    mask = lane != value;
+  } else if constexpr (Op == CmpOp::LT) {
+    mask = lane < value;
+  } else if constexpr (Op == CmpOp::LE) {
+    mask = lane <= value;
+  } else if constexpr (Op == CmpOp::GT) {
+    mask = lane > value;
+  } else {
+    mask = lane >= value;
+  }
+}
+
+#if VECTOR_X86_SIMD
+
+// One bit per lane of a comparison mask. Builtins rather than intrinsics, so the 32-byte
+// variants expand inside the target("avx2") wrappers the kernels are inlined into.
+template<typename ElemT, size_t Bytes, typename MaskT>
+SIMD_KERNEL_INLINE uint32_t MoveMask(const MaskT& mask) {
+  using Floats = typename SimdLane<float, Bytes>::Type;
+  using Doubles = typename SimdLane<double, Bytes>::Type;
+  using Chars = typename SimdLane<char, Bytes>::Type;
+
+  if constexpr (sizeof(ElemT) == 4) {
+    Floats lanes;
+    __builtin_memcpy(&lanes, &mask, sizeof(lanes));
+    if constexpr (Bytes == 32) {
+      return __builtin_ia32_movmskps256(lanes);
+    } else {
+      return __builtin_ia32_movmskps(lanes);
+    }
+  } else if constexpr (sizeof(ElemT) == 8) {
+    Doubles lanes;
+    __builtin_memcpy(&lanes, &mask, sizeof(lanes));
+    if constexpr (Bytes == 32) {
+      return __builtin_ia32_movmskpd256(lanes);
+    } else {
+      return __builtin_ia32_movmskpd(lanes);
+    }
+  } else {
+    Chars lanes;
+    __builtin_memcpy(&lanes, &mask, sizeof(lanes));
+    uint32_t bits;
+    if constexpr (Bytes == 32) {
+      bits = __builtin_ia32_pmovmskb256(lanes);
+    } else {
+      bits = __builtin_ia32_pmovmskb128(lanes);
+    }
+    if constexpr (sizeof(ElemT) == 2) {
+      bits &= 0x55555555;
+      bits = (bits | (bits >> 1)) & 0x33333333;
+      bits = (bits | (bits >> 2)) & 0x0f0f0f0f;
+      bits = (bits | (bits >> 4)) & 0x00ff00ff;
+      bits = (bits | (bits >> 8)) & 0x0000ffff;
+    }
+    return bits;
+  }
+}
+
+template<CmpOp Op, typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE size_t FindKernel(const ElemT* data, const size_t count, const ElemT value) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  const typename Lane::Type lane_value = Lane::Broadcast(value);
+
+  size_t i = 0;
+  for (; i + Lane::COUNT <= count; i += Lane::COUNT) {
+    typename Lane::Mask mask;
+    CompareLane<Op, Lane>(mask, Lane::Load(data + i), lane_value);
+    const uint32_t bits = MoveMask<ElemT, Bytes>(mask);
+    if (bits != 0) {
+      return i + std::countr_zero(bits);
+    }
+  }
+  for (; i < count; ++i) {
+    if (Compare<Op, ElemT>{value}(data[i])) {
+      return i;
+    }
+  }
+  return count;
+}
+
+// Lane-wise counters are subtracted the all-ones masks and flushed before they can overflow.
+template<CmpOp Op, typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE size_t CountKernel(const ElemT* data, const size_t count, const ElemT value) {
+  using Lane = SimdLane<ElemT, Bytes>;
+  using Counter = typename Lane::Mask;
+  static constexpr size_t FLUSH_BLOCKS = 64;
+
+  const typename Lane::Type lane_value = Lane::Broadcast(value);
+  size_t matches = 0;
+
+  size_t i = 0;
+  while (i + Lane::COUNT <= count) {
+    Counter counter{};
+    for (size_t block = 0; block < FLUSH_BLOCKS && i + Lane::COUNT <= count; ++block, i += Lane::COUNT) {
+      Counter mask;
+      CompareLane<Op, Lane>(mask, Lane::Load(data + i), lane_value);
+      counter -= mask;
+    }
+    for (size_t j = 0; j < Lane::COUNT; ++j) {
+      matches += static_cast<size_t>(counter[j]);
+    }
+  }
+  for (; i < count; ++i) {
+    matches += Compare<Op, ElemT>{value}(data[i]);
+  }
+  return matches;
+}
+
+// Indices that gather the selected 32-bit lanes of an 8-lane register to the front.
+inline constexpr std::array<std::array<uint32_t, 8>, 256> MakeCompressTable32() {
+  std::array<std::array<uint32_t, 8>, 256> table{};
+  for (size_t mask = 0; mask < 256; ++mask) {
+    size_t pos = 0;
+    for (uint32_t lane = 0; lane < 8; ++lane) {
+      if (mask & (size_t{1} << lane)) {
+        table[mask][pos++] = lane;
+      }
+    }
+  }
+  return table;
+}
+
+// The same for 64-bit lanes, as pairs of 32-bit indices.
+inline constexpr std::array<std::array<uint32_t, 8>, 16> MakeCompressTable64() {
+  std::array<std::array<uint32_t, 8>, 16> table{};
+  for (size_t mask = 0; mask < 16; ++mask) {
+    size_t pos = 0;
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+      if (mask & (size_t{1} << lane)) {
+        table[mask][pos++] = 2 * lane;
+        table[mask][pos++] = 2 * lane + 1;
+      }
+    }
+  }
+  return table;
+}
+
+inline constexpr std::array<std::array<uint32_t, 8>, 256> COMPRESS_TABLE_32 = MakeCompressTable32();
+inline constexpr std::array<std::array<uint32_t, 8>, 16> COMPRESS_TABLE_64 = MakeCompressTable64();
+
+#endif
+
+// Moves the elements whose comparison result equals Keep to the front, in order, and returns
+// their count. With 32-byte lanes and 4- or 8-byte elements each block is compressed with a
+// permutation from the tables above and stored whole; the store never passes the block just
+// loaded, so it is safe in place.
+template<CmpOp Op, bool Keep, typename ElemT, size_t Bytes>
+SIMD_KERNEL_INLINE size_t CompactKernel(ElemT* data, const size_t count, const ElemT value) {
+  size_t out = 0;
+  size_t i = 0;
+
+#if VECTOR_X86_SIMD
+  if constexpr (Bytes == 32 && (sizeof(ElemT) == 4 || sizeof(ElemT) == 8)) {
+    using Lane = SimdLane<ElemT, Bytes>;
+    typedef int Indices __attribute__((vector_size(32)));
+
+    const typename Lane::Type lane_value = Lane::Broadcast(value);
+    for (; i + Lane::COUNT <= count; i += Lane::COUNT) {
+      const typename Lane::Type lane = Lane::Load(data + i);
+      typename Lane::Mask mask;
+      CompareLane<Op, Lane>(mask, lane, lane_value);
+      uint32_t bits = MoveMask<ElemT, Bytes>(mask);
+      if constexpr (!Keep) {
+        bits = ~bits & ((1u << Lane::COUNT) - 1);
+      }
+
+      const uint32_t* perm = sizeof(ElemT) == 4 ? COMPRESS_TABLE_32[bits].data() : COMPRESS_TABLE_64[bits].data();
+      Indices indices;
+      Indices lane_bits;
+      __builtin_memcpy(&indices, perm, sizeof(Indices));
+      __builtin_memcpy(&lane_bits, &lane, sizeof(Indices));
+      const Indices packed = __builtin_ia32_permvarsi256(lane_bits, indices);
+      __builtin_memcpy(data + out, &packed, sizeof(Indices));
+      out += std::popcount(bits);
+    }
+  }
+#endif
+
+  const Compare<Op, ElemT> pred{value};
+  for (; i < count; ++i) {
+    data[out] = data[i];
+    out += pred(data[i]) == Keep;
+  }
+  return out;
+}
+
+#if VECTOR_X86_SIMD
+
+template<CmpOp Op, typename ElemT>
+size_t FindSse2(const ElemT* data, const size_t count, const ElemT value) {
+  return FindKernel<Op, ElemT, 16>(data, count, value);
+}
+
+template<CmpOp Op, typename ElemT>
+__attribute__((target("avx2"))) size_t FindAvx2(const ElemT* data, const size_t count, const ElemT value) {
+  return FindKernel<Op, ElemT, 32>(data, count, value);
+}
+
+template<CmpOp Op, typename ElemT>
+size_t CountSse2(const ElemT* data, const size_t count, const ElemT value) {
+  return CountKernel<Op, ElemT, 16>(data, count, value);
+}
+
+template<CmpOp Op, typename ElemT>
+__attribute__((target("avx2"))) size_t CountAvx2(const ElemT* data, const size_t count, const ElemT value) {
+  return CountKernel<Op, ElemT, 32>(data, count, value);
+}
+
+template<CmpOp Op, bool Keep, typename ElemT>
+size_t CompactSse2(ElemT* data, const size_t count, const ElemT value) {
+  return CompactKernel<Op, Keep, ElemT, 16>(data, count, value);
+}
+
+template<CmpOp Op, bool Keep, typename ElemT>
+__attribute__((target("avx2,popcnt"))) size_t CompactAvx2(ElemT* data, const size_t count, const ElemT value) {
+  return CompactKernel<Op, Keep, ElemT, 32>(data, count, value);
+}
+
+template<CmpOp Op, typename ElemT>
+inline size_t SimdFind(const ElemT* data, const size_t count, const ElemT value) {
+  static const auto kernel = CpuFeatures::Get().avx2 ? FindAvx2<Op, ElemT> : FindSse2<Op, ElemT>;
+  return kernel(data, count, value);
+}
+
+template<CmpOp Op, typename ElemT>
+inline size_t SimdCount(const ElemT* data, const size_t count, const ElemT value) {
+  static const auto kernel = CpuFeatures::Get().avx2 ? CountAvx2<Op, ElemT> : CountSse2<Op, ElemT>;
+  return kernel(data, count, value);
+}
+
+template<CmpOp Op, bool Keep, typename ElemT>
+inline size_t SimdCompact(ElemT* data, const size_t count, const ElemT value) {
+  static const auto kernel = CpuFeatures::Get().avx2 ? CompactAvx2<Op, Keep, ElemT> : CompactSse2<Op, Keep, ElemT>;
+  return kernel(data, count, value);
+}
+
+#else
+
+template<CmpOp Op, typename ElemT>
+inline size_t SimdFind(const ElemT* data, const size_t count, const ElemT value) {
+  const Compare<Op, ElemT> pred{value};
+  for (size_t i = 0; i < count; ++i) {
+    if (pred(data[i])) {
+      return i;
+    }
+  }
+  return count;
+}
+
+template<CmpOp Op, typename ElemT>
+inline size_t SimdCount(const ElemT* data, const size_t count, const ElemT value) {
+  const Compare<Op, ElemT> pred{value};
+  size_t matches = 0;
+  for (size_t i = 0; i < count; ++i) {
+    matches += pred(data[i]);
+  }
+  return matches;
+}
+
+template<CmpOp Op, bool Keep, typename ElemT>
+inline size_t SimdCompact(ElemT* data, const size_t count, const ElemT value) {
+  return CompactKernel<Op, Keep, ElemT, 16>(data, count, value);
+}
+
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif /* simd_search.hpp */
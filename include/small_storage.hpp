@@ -0,0 +1,265 @@
+#ifndef SMALL_STORAGE_HPP
+#define SMALL_STORAGE_HPP
+
+#include <cstddef>
+#include <cassert>
+#include <utility>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <memory>
+#include "object_helpers.hpp"
+
+template<
+  typename ElemT,
+  size_t N,
+  template<typename T_> class Allocator = std::allocator
+>
+class SmallStorage {
+ public:
+  SmallStorage() {
+  }
+
+  SmallStorage(const size_t size) {
+    Reserve(size);
+    size_ = DefaultConstruct(buffer_, size);
+  }
+
+  SmallStorage(const size_t size, const ElemT& value) {
+    Reserve(size);
+    size_ = Construct(buffer_, size, value);
+  }
+
+  SmallStorage(const SmallStorage& other_copy) : allocator_{other_copy.allocator_} {
+    Reserve(other_copy.size_);
+    if constexpr (std::is_trivially_copyable_v<ElemT>) {
+      if (other_copy.size_ != 0) {
+        std::memcpy(static_cast<void*>(buffer_), static_cast<const void*>(other_copy.buffer_),
+                    other_copy.size_ * sizeof(ElemT));
+      }
+      size_ = other_copy.size_;
+    } else {
+      try {
+        while (size_ < other_copy.size_) {
+          ConstructOne(buffer_ + size_, other_copy.At(size_));
+          ++size_;
+        }
+      } catch (...) {
+        Clear();
+        throw;
+      }
+    }
+  }
+
+  SmallStorage(SmallStorage&& other_move) {
+    StealFrom(other_move);
+  }
+
+  ~SmallStorage() {
+    Clear();
+  }
+
+  SmallStorage& operator=(const SmallStorage& other_copy) {
+    if (this == &other_copy) {
+      return *this;
+    }
+
+    SmallStorage tmp(other_copy);
+    Clear();
+    StealFrom(tmp);
+    return *this;
+  }
+
+  SmallStorage& operator=(SmallStorage&& other_move) {
+    if (this == &other_move) {
+      return *this;
+    }
+
+    Clear();
+    StealFrom(other_move);
+    return *this;
+  }
+
+  [[nodiscard]] inline size_t Size() const {
+    return size_;
+  }
+
+  [[nodiscard]] inline size_t Capacity() const {
+    return capacity_;
+  }
+
+  [[nodiscard]] inline bool IsInline() const {
+    return buffer_ == InlineBuffer();
+  }
+
+  [[nodiscard]] inline ElemT* Buffer() {
+    return buffer_;
+  }
+
+  [[nodiscard]] inline const ElemT* Buffer() const {
+    return buffer_;
+  }
+
+  [[nodiscard]] inline const Allocator<ElemT>& GetAllocator() const {
+    return allocator_;
+  }
+
+  [[nodiscard]] inline ElemT& At(const size_t index) {
+    return buffer_[index];
+  }
+
+  [[nodiscard]] inline const ElemT& At(const size_t index) const {
+    return buffer_[index];
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    return size_ == 0 || CallSegment(func, buffer_, size_);
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return size_ == 0 || CallSegment(func, static_cast<const ElemT*>(buffer_), size_);
+  }
+
+  void Resize(const size_t new_size) {
+    ResizeWith(new_size, [](ElemT* buffer, const size_t first, const size_t last) {
+      return DefaultConstruct(buffer, first, last);
+    });
+  }
+
+  void ResizeDefaultInit(const size_t new_size) {
+    ResizeWith(new_size, [](ElemT* buffer, const size_t first, const size_t last) {
+      return DefaultInit(buffer, first, last);
+    });
+  }
+
+  void Reserve(const size_t capacity) {
+    if (capacity > capacity_) {
+      Reallocate(capacity);
+    }
+  }
+
+  ElemT* ReserveBack() {
+    if (size_ == capacity_) {
+      Reallocate(2 * capacity_ + 1);
+    }
+    ++size_;
+    return &buffer_[size_ - 1];
+  }
+
+  void RollBackReservedBack() {
+    assert(size_ != 0);
+
+    --size_;
+  }
+
+  ElemT* ReserveBack(const size_t count) {
+    if (size_ + count > capacity_) {
+      Reallocate(std::max(size_ + count, 2 * capacity_));
+    }
+    size_ += count;
+    return buffer_ + size_ - count;
+  }
+
+  void RollBackReservedBack(const size_t count) {
+    assert(size_ >= count);
+
+    size_ -= count;
+  }
+
+  void Shrink() {
+    if (IsInline() || capacity_ == size_) {
+      return;
+    }
+
+    ElemT* old_buffer = buffer_;
+    const size_t old_capacity = capacity_;
+    if (size_ <= N) {
+      RelocateTo(InlineBuffer(), old_buffer, size_);
+      buffer_ = InlineBuffer();
+      capacity_ = N;
+    } else {
+      buffer_ = Relocate(allocator_, old_buffer, size_, size_);
+      capacity_ = size_;
+    }
+    allocator_.deallocate(old_buffer, old_capacity);
+  }
+
+ private:
+  [[nodiscard]] inline ElemT* InlineBuffer() {
+    return reinterpret_cast<ElemT*>(raw_buffer_);
+  }
+
+  [[nodiscard]] inline const ElemT* InlineBuffer() const {
+    return reinterpret_cast<const ElemT*>(raw_buffer_);
+  }
+
+  template<typename ConstructT>
+  void ResizeWith(const size_t new_size, ConstructT&& construct) {
+    if (new_size == size_) {
+      return;
+    }
+
+    if (new_size < size_) {
+      Destruct(buffer_, new_size, size_);
+      size_ = new_size;
+      return;
+    }
+
+    if (new_size > capacity_) {
+      Reallocate(std::max(new_size, 2 * capacity_));
+    }
+    size_ = construct(buffer_, size_, new_size);
+  }
+
+  void Reallocate(const size_t new_capacity) {
+    assert(new_capacity >= size_);
+
+    ElemT* old_buffer = buffer_;
+    buffer_ = Relocate(allocator_, old_buffer, new_capacity, size_);
+    if (old_buffer != InlineBuffer()) {
+      allocator_.deallocate(old_buffer, capacity_);
+    }
+    capacity_ = new_capacity;
+  }
+
+  void Clear() {
+    Destruct(buffer_, size_);
+    if (!IsInline()) {
+      allocator_.deallocate(buffer_, capacity_);
+    }
+    buffer_ = InlineBuffer();
+    capacity_ = N;
+    size_ = 0;
+  }
+
+  // Expects this storage to be empty and inline.
+  void StealFrom(SmallStorage& other) {
+    assert(size_ == 0 && IsInline());
+
+    if (other.IsInline()) {
+      RelocateTo(buffer_, other.buffer_, other.size_);
+    } else {
+      std::swap(allocator_, other.allocator_);
+      buffer_ = other.buffer_;
+      capacity_ = other.capacity_;
+      other.buffer_ = other.InlineBuffer();
+      other.capacity_ = N;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+ private:
+  Allocator<ElemT> allocator_;
+
+  alignas(ElemT) uint8_t raw_buffer_[std::max(N, size_t{1}) * sizeof(ElemT)];
+  ElemT* buffer_ = reinterpret_cast<ElemT*>(raw_buffer_);
+
+  size_t capacity_{N};
+  size_t size_{0};
+
+};
+
+#endif /* small_storage.hpp */
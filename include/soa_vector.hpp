@@ -0,0 +1,362 @@
+#ifndef SOA_VECTOR_HPP
+#define SOA_VECTOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+#include "error_msgs.hpp"
+
+// Declares the fields of an aggregate for SoaVector, in column order:
+// template<>
+// struct SoaLayout<Point> {
+//   static constexpr auto MEMBERS = std::make_tuple(&Point::x_, &Point::y_);
+// };
+template<typename RowT>
+struct SoaLayout;
+
+template<typename RowT>
+concept HasSoaLayout = requires {
+  SoaLayout<RowT>::MEMBERS;
+};
+
+template<typename MemberPtrT>
+struct MemberPtrTraits;
+
+template<typename ClassT, typename MemberT>
+struct MemberPtrTraits<MemberT ClassT::*> {
+  using type = MemberT;
+};
+
+template<typename RowT>
+struct SoaFields;
+
+template<typename... Fields>
+struct SoaFields<std::tuple<Fields...>> {
+  using type = std::tuple<Fields...>;
+};
+
+template<HasSoaLayout RowT>
+struct SoaFields<RowT> {
+  template<typename MembersT>
+  struct FromMembers;
+
+  template<typename... MemberPtrs>
+  struct FromMembers<std::tuple<MemberPtrs...>> {
+    using type = std::tuple<typename MemberPtrTraits<MemberPtrs>::type...>;
+  };
+
+  using type = typename FromMembers<std::remove_cv_t<decltype(SoaLayout<RowT>::MEMBERS)>>::type;
+};
+
+// Field I of a row, whether the row is a tuple or an aggregate with a SoaLayout.
+template<size_t I, typename RowT>
+inline decltype(auto) SoaRowField(RowT&& row) {
+  using Row = std::remove_cvref_t<RowT>;
+  if constexpr (HasSoaLayout<Row>) {
+    return (std::forward<RowT>(row).*std::get<I>(SoaLayout<Row>::MEMBERS));
+  } else {
+    return std::get<I>(std::forward<RowT>(row));
+  }
+}
+
+template<typename SoaVectorT>
+class SoaRowRef;
+
+template<typename SoaVectorT>
+class SoaRowIterator;
+
+// Keeps one Vector per field, each with the given storage, so a scan over one field
+// touches only that field's memory. Rows are reached through SoaRowRef proxies, whole
+// columns through Column and ColumnSpan.
+template<
+  typename RowT,
+  template<typename StorageT, size_t StorageSize> class Storage = DynamicStorage,
+  typename CheckPolicy = AlwaysCheck
+>
+class BasicSoaVector {
+ public:
+  using value_type = RowT;
+  using fields = typename SoaFields<RowT>::type;
+
+  template<size_t I>
+  using field_type = std::tuple_element_t<I, fields>;
+
+  template<size_t I>
+  using column_type = Vector<field_type<I>, Storage, 0, CheckPolicy>;
+
+  using reference = SoaRowRef<BasicSoaVector>;
+  using const_reference = SoaRowRef<const BasicSoaVector>;
+
+  using iterator = SoaRowIterator<BasicSoaVector>;
+  using const_iterator = SoaRowIterator<const BasicSoaVector>;
+
+  static constexpr size_t FIELDS_CNT = std::tuple_size_v<fields>;
+
+ public:
+  BasicSoaVector() = default;
+
+  explicit BasicSoaVector(const size_t size) {
+    Resize(size);
+  }
+
+  [[nodiscard]] inline size_t Size() const noexcept {
+    return std::get<0>(columns_).Size();
+  }
+
+  template<size_t I>
+  [[nodiscard]] inline column_type<I>& Column() noexcept {
+    return std::get<I>(columns_);
+  }
+
+  template<size_t I>
+  [[nodiscard]] inline const column_type<I>& Column() const noexcept {
+    return std::get<I>(columns_);
+  }
+
+  template<size_t I>
+  [[nodiscard]] inline std::span<field_type<I>> ColumnSpan() noexcept requires column_type<I>::IS_CONTIGUOUS {
+    return std::span<field_type<I>>(Column<I>().Data(), Size());
+  }
+
+  template<size_t I>
+  [[nodiscard]] inline std::span<const field_type<I>> ColumnSpan() const noexcept
+    requires column_type<I>::IS_CONTIGUOUS {
+    return std::span<const field_type<I>>(Column<I>().Data(), Size());
+  }
+
+  [[nodiscard]] reference operator[](const size_t index) {
+    CheckIndex(index);
+    return reference(this, index);
+  }
+
+  [[nodiscard]] const_reference operator[](const size_t index) const {
+    CheckIndex(index);
+    return const_reference(this, index);
+  }
+
+  inline iterator begin() {
+    return iterator(this, 0);
+  }
+
+  inline iterator end() {
+    return iterator(this, Size());
+  }
+
+  inline const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+
+  inline const_iterator end() const {
+    return const_iterator(this, Size());
+  }
+
+  // Takes one argument per field and constructs each in its own column. If a column
+  // throws, the fields already added to the others are removed again.
+  template<typename... ArgsT>
+  void EmplaceBack(ArgsT&&... args) {
+    static_assert(sizeof...(ArgsT) == FIELDS_CNT, "EmplaceBack takes one argument per field");
+    size_t added = 0;
+    try {
+      EmplaceColumns(added, std::index_sequence_for<ArgsT...>{}, std::forward<ArgsT>(args)...);
+    } catch (...) {
+      RollBackColumns(added, std::make_index_sequence<FIELDS_CNT>{});
+      throw;
+    }
+  }
+
+  void PushBack(const RowT& row) {
+    PushRow(row, std::make_index_sequence<FIELDS_CNT>{});
+  }
+
+  void PopBack() {
+    if (Size() == 0) {
+      throw std::range_error(BAD_POP_MSG);
+    }
+    ForEachColumn([](auto& column) {
+      column.PopBack();
+    });
+  }
+
+  void Resize(const size_t new_size) {
+    ForEachColumn([new_size](auto& column) {
+      column.Resize(new_size);
+    });
+  }
+
+  void Reserve(const size_t capacity) {
+    ForEachColumn([capacity](auto& column) {
+      column.Reserve(capacity);
+    });
+  }
+
+  void Shrink() {
+    ForEachColumn([](auto& column) {
+      column.Shrink();
+    });
+  }
+
+ private:
+  template<typename FuncT>
+  void ForEachColumn(FuncT&& func) {
+    std::apply([&func](auto&... columns) {
+      (func(columns), ...);
+    }, columns_);
+  }
+
+  inline void CheckIndex(const size_t index) const {
+    if constexpr (CheckPolicy::ENABLED) {
+      if (index >= Size()) {
+        throw std::out_of_range(BAD_INDEX_MSG);
+      }
+    }
+  }
+
+  template<size_t... Is, typename... ArgsT>
+  void EmplaceColumns(size_t& added, std::index_sequence<Is...>, ArgsT&&... args) {
+    ((std::get<Is>(columns_).EmplaceBack(std::forward<ArgsT>(args)), ++added), ...);
+  }
+
+  template<size_t... Is>
+  void RollBackColumns(const size_t added, std::index_sequence<Is...>) {
+    ((Is < added ? std::get<Is>(columns_).PopBack() : void()), ...);
+  }
+
+  template<size_t... Is>
+  void PushRow(const RowT& row, std::index_sequence<Is...>) {
+    EmplaceBack(SoaRowField<Is>(row)...);
+  }
+
+ private:
+  template<typename FieldsT>
+  struct ColumnsOf;
+
+  template<typename... Fields>
+  struct ColumnsOf<std::tuple<Fields...>> {
+    using type = std::tuple<Vector<Fields, Storage, 0, CheckPolicy>...>;
+  };
+
+  typename ColumnsOf<fields>::type columns_;
+
+};
+
+// Stands for one row: Get<I>() reaches its field I in place, converting to RowT gathers
+// the row, and assigning a RowT scatters it back.
+template<typename SoaVectorT>
+class SoaRowRef {
+ public:
+  using row_type = typename std::remove_const_t<SoaVectorT>::value_type;
+
+  static constexpr bool IS_CONST = std::is_const_v<SoaVectorT>;
+
+ public:
+  SoaRowRef(SoaVectorT* vector, const size_t index) : vector_{vector}, index_{index} {
+  }
+
+  SoaRowRef(const SoaRowRef&) = default;
+
+  template<size_t I>
+  [[nodiscard]] inline decltype(auto) Get() const {
+    return vector_->template Column<I>().At(index_);
+  }
+
+  [[nodiscard]] inline size_t Index() const {
+    return index_;
+  }
+
+  operator row_type() const {
+    return Load(std::make_index_sequence<std::remove_const_t<SoaVectorT>::FIELDS_CNT>{});
+  }
+
+  const SoaRowRef& operator=(const row_type& row) const requires (!IS_CONST) {
+    Store(row, std::make_index_sequence<std::remove_const_t<SoaVectorT>::FIELDS_CNT>{});
+    return *this;
+  }
+
+  const SoaRowRef& operator=(const SoaRowRef& other) const requires (!IS_CONST) {
+    return *this = static_cast<row_type>(other);
+  }
+
+ private:
+  template<size_t... Is>
+  row_type Load(std::index_sequence<Is...>) const {
+    if constexpr (HasSoaLayout<row_type>) {
+      row_type row{};
+      ((SoaRowField<Is>(row) = Get<Is>()), ...);
+      return row;
+    } else {
+      return row_type(Get<Is>()...);
+    }
+  }
+
+  template<size_t... Is>
+  void Store(const row_type& row, std::index_sequence<Is...>) const {
+    ((Get<Is>() = SoaRowField<Is>(row)), ...);
+  }
+
+ private:
+  SoaVectorT* vector_;
+  size_t index_;
+
+};
+
+template<typename SoaVectorT>
+class SoaRowIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename std::remove_const_t<SoaVectorT>::value_type;
+  using reference = SoaRowRef<SoaVectorT>;
+  using difference_type = std::ptrdiff_t;
+
+ public:
+  SoaRowIterator() = default;
+
+  SoaRowIterator(SoaVectorT* vector, const size_t index) : vector_{vector}, index_{index} {
+  }
+
+  inline reference operator*() const {
+    return reference(vector_, index_);
+  }
+
+  inline SoaRowIterator& operator++() {
+    ++index_;
+    return *this;
+  }
+
+  inline SoaRowIterator operator++(int) {
+    SoaRowIterator old = *this;
+    ++index_;
+    return old;
+  }
+
+  inline bool operator==(const SoaRowIterator& other) const {
+    return index_ == other.index_;
+  }
+
+ private:
+  SoaVectorT* vector_{nullptr};
+  size_t index_{0};
+
+};
+
+// A single aggregate with a SoaLayout is split into its declared members; anything else
+// is a list of fields: SoaVector<Point>, SoaVector<float, float, int>.
+template<typename... Fields>
+struct SoaRowOf {
+  using type = std::tuple<Fields...>;
+};
+
+template<HasSoaLayout RowT>
+struct SoaRowOf<RowT> {
+  using type = RowT;
+};
+
+template<typename... Fields>
+using SoaVector = BasicSoaVector<typename SoaRowOf<Fields...>::type>;
+
+#endif /* soa_vector.hpp */
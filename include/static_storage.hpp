@@ -6,7 +6,9 @@
 #include <utility>
 #include <cstdint>
 #include <new>
+#include <stdexcept>
 #include "object_helpers.hpp"
+#include "error_msgs.hpp"
 
 template<
   typename ElemT,
@@ -17,54 +19,54 @@ class StaticStorage {
   StaticStorage() {
   }
 
-  StaticStorage(const size_t size) :
-    size_{DefaultConstruct(buffer_, size)} {
+  StaticStorage(const size_t size) {
+    Reserve(size);
+    size_ = DefaultConstruct(buffer_, size);
   }
 
-  StaticStorage(const size_t size, const ElemT& value) :
-    size_{Construct(buffer_, size, value)} {
+  StaticStorage(const size_t size, const ElemT& value) {
+    Reserve(size);
+    size_ = Construct(buffer_, size, value);
   }
 
   StaticStorage(const StaticStorage& other_copy) {
-    while (size_ < other_copy.size_) {
-      Construct(buffer_ + size_, other_copy.At(size_));
-      ++size_;
+    try {
+      while (size_ < other_copy.size_) {
+        ConstructOne(buffer_ + size_, other_copy.At(size_));
+        ++size_;
+      }
+    } catch (...) {
+      Destruct(buffer_, size_);
+      throw;
     }
   }
 
   StaticStorage(StaticStorage&& other_move) {
-    while (size_ < other_move.size_) {
-      Construct(buffer_ + size_, std::move(other_move.At(size_)));
-      ++size_;
-    }
-    other_move.buffer_ = nullptr;
-    other_move.size_ = 0;
+    MoveFrom(other_move);
   }
 
   ~StaticStorage() {
     Destruct(buffer_, size_);
   }
 
-  StaticStorage& operator=(StaticStorage& other_copy) {
-    if (other_copy == this) {
+  StaticStorage& operator=(const StaticStorage& other_copy) {
+    if (&other_copy == this) {
       return *this;
     }
 
     StaticStorage tmp(other_copy);
-    std::swap(*this, other_copy);
+    Clear();
+    MoveFrom(tmp);
     return *this;
   }
 
   StaticStorage& operator=(StaticStorage&& other_move) {
-    if (other_move == *this) {
+    if (&other_move == this) {
       return *this;
     }
 
-    for (size_t i = 0; i < other_move.size_; ++i) {
-      Construct(buffer_ + i, std::move_if_noexcept(other_move.At(i)));
-      size_ = std::max(size_, i);
-    }
-
+    Clear();
+    MoveFrom(other_move);
     return *this;
   }
 
@@ -88,22 +90,31 @@ class StaticStorage {
     return buffer_[index];
   }
 
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    return size_ == 0 || CallSegment(func, buffer_, size_);
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return size_ == 0 || CallSegment(func, static_cast<const ElemT*>(buffer_), size_);
+  }
+
   void Resize(const size_t new_size) {
-    if (new_size == size_) {
-      return;
-    }
+    ResizeWith(new_size, [](ElemT* buffer, const size_t first, const size_t last) {
+      return DefaultConstruct(buffer, first, last);
+    });
+  }
 
-    if (new_size > MaxSize) {
-      throw std::out_of_range(BAD_STATIC_OVRFLW);
-    }
+  void ResizeDefaultInit(const size_t new_size) {
+    ResizeWith(new_size, [](ElemT* buffer, const size_t first, const size_t last) {
+      return DefaultInit(buffer, first, last);
+    });
+  }
 
-    if (new_size < size_) {
-      Destruct(buffer_, size_, new_size);
-    } else {
-      while (size_ < new_size) {
-        DefaultConstruct(buffer_, size_);
-        ++size_;
-      }
+  void Reserve(const size_t capacity) {
+    if (capacity > MaxSize) {
+      throw std::out_of_range(BAD_STATIC_OVRFLW);
     }
   }
 
@@ -121,11 +132,56 @@ class StaticStorage {
     --size_;
   }
 
+  ElemT* ReserveBack(const size_t count) {
+    if (count > MaxSize - size_) {
+      throw std::logic_error(BAD_PUSH_BACK);
+    }
+    size_ += count;
+    return buffer_ + size_ - count;
+  }
+
+  void RollBackReservedBack(const size_t count) {
+    assert(size_ >= count);
+
+    size_ -= count;
+  }
+
   void Shrink() {
   }
 
  private:
-  uint8_t raw_buffer_[MaxSize * sizeof(ElemT)];
+  template<typename ConstructT>
+  void ResizeWith(const size_t new_size, ConstructT&& construct) {
+    if (new_size == size_) {
+      return;
+    }
+
+    Reserve(new_size);
+
+    if (new_size < size_) {
+      Destruct(buffer_, new_size, size_);
+      size_ = new_size;
+    } else {
+      size_ = construct(buffer_, size_, new_size);
+    }
+  }
+
+  void Clear() {
+    Destruct(buffer_, size_);
+    size_ = 0;
+  }
+
+  // Expects this storage to be empty.
+  void MoveFrom(StaticStorage& other) {
+    assert(size_ == 0);
+
+    RelocateTo(buffer_, other.buffer_, other.size_);
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+ private:
+  alignas(ElemT) uint8_t raw_buffer_[MaxSize * sizeof(ElemT)];
   ElemT* buffer_ = reinterpret_cast<ElemT*>(raw_buffer_);
 
   size_t size_{0};
@@ -0,0 +1,228 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads with one task deque each. A worker pops its own deque from
+// the back and steals from the front of the others when it runs dry. Run(tasks_cnt, func)
+// is the only way to submit work: the calling thread helps until every task of the batch
+// has finished, so Run may be called from inside a task as well.
+class ThreadPool {
+ public:
+  // threads_cnt threads take part in Run, the calling one included.
+  explicit ThreadPool(const size_t threads_cnt = DefaultThreadsCnt()) : queues_cnt_{threads_cnt > 1 ? threads_cnt - 1 : 0} {
+    queues_ = std::make_unique<TaskQueue[]>(queues_cnt_);
+    workers_.reserve(queues_cnt_);
+    for (size_t i = 0; i < queues_cnt_; ++i) {
+      workers_.emplace_back([this, i] {
+        WorkerLoop(i);
+      });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  [[nodiscard]] inline size_t ThreadsCnt() const {
+    return queues_cnt_ + 1;
+  }
+
+  // Calls func(i) for every i in [0, tasks_cnt) and returns when all calls have finished.
+  // The first exception thrown by a task is rethrown here once the rest have run.
+  template<typename FuncT>
+  void Run(const size_t tasks_cnt, FuncT&& func) {
+    if (queues_cnt_ == 0 || tasks_cnt <= 1) {
+      for (size_t i = 0; i < tasks_cnt; ++i) {
+        func(i);
+      }
+      return;
+    }
+
+    auto call = [&func](const size_t index) {
+      func(index);
+    };
+    Batch batch(tasks_cnt, &call, [](void* ctx, const size_t index) {
+      (*static_cast<decltype(call)*>(ctx))(index);
+    });
+    Submit(batch);
+
+    const size_t self = CurrentQueue();
+    Task task;
+    while (batch.pending.load(std::memory_order_acquire) != 0 && TryTake(self, task)) {
+      Execute(task);
+    }
+    {
+      std::unique_lock<std::mutex> lock(batch.mutex);
+      batch.done_cv.wait(lock, [&batch] {
+        return batch.done;
+      });
+    }
+
+    if (batch.error != nullptr) {
+      std::rethrow_exception(batch.error);
+    }
+  }
+
+  static ThreadPool& Default() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  static size_t DefaultThreadsCnt() {
+    const size_t hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+  }
+
+ private:
+  struct Batch {
+    Batch(const size_t tasks_cnt, void* batch_func, void (*batch_invoke)(void*, size_t)) :
+      pending{tasks_cnt}, func{batch_func}, invoke{batch_invoke} {
+    }
+
+    std::atomic<size_t> pending;
+    void* func;
+    void (*invoke)(void* func, size_t index);
+
+    std::atomic_flag failed = ATOMIC_FLAG_INIT;
+    std::exception_ptr error;
+
+    // The caller may destroy the batch as soon as it sees done, so the last task sets it
+    // under the mutex and touches nothing afterwards. pending reaching zero is not enough.
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done{false};
+  };
+
+  struct Task {
+    Batch* batch{nullptr};
+    size_t index{0};
+  };
+
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Index of the calling worker's queue in this pool, or queues_cnt_ for any other thread.
+  size_t CurrentQueue() const {
+    return current_pool_ == this ? current_queue_ : queues_cnt_;
+  }
+
+  // A worker keeps a nested batch on its own deque for the others to steal; an outside
+  // caller deals the tasks out round-robin.
+  void Submit(Batch& batch) {
+    const size_t tasks_cnt = batch.pending.load(std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      queued_.fetch_add(tasks_cnt, std::memory_order_relaxed);
+    }
+
+    const size_t self = CurrentQueue();
+    for (size_t i = 0; i < tasks_cnt; ++i) {
+      TaskQueue& queue = queues_[self != queues_cnt_ ? self : i % queues_cnt_];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back({&batch, i});
+    }
+    sleep_cv_.notify_all();
+  }
+
+  bool TryTake(const size_t self, Task& task) {
+    if (self != queues_cnt_) {
+      TaskQueue& own = queues_[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = own.tasks.back();
+        own.tasks.pop_back();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+
+    for (size_t i = 1; i <= queues_cnt_; ++i) {
+      TaskQueue& victim = queues_[(self + i) % queues_cnt_];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static void Execute(const Task& task) {
+    Batch& batch = *task.batch;
+    try {
+      batch.invoke(batch.func, task.index);
+    } catch (...) {
+      if (!batch.failed.test_and_set()) {
+        batch.error = std::current_exception();
+      }
+    }
+
+    if (batch.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lock(batch.mutex);
+      batch.done = true;
+      batch.done_cv.notify_all();
+    }
+  }
+
+  void WorkerLoop(const size_t self) {
+    current_pool_ = this;
+    current_queue_ = self;
+
+    Task task;
+    while (true) {
+      if (TryTake(self, task)) {
+        Execute(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.wait(lock, [this] {
+        return stop_ || queued_.load(std::memory_order_relaxed) != 0;
+      });
+      if (stop_ && queued_.load(std::memory_order_relaxed) == 0) {
+        return;
+      }
+    }
+  }
+
+ private:
+  size_t queues_cnt_{0};
+  std::unique_ptr<TaskQueue[]> queues_;
+  std::vector<std::thread> workers_;
+
+  // Tasks submitted and not taken yet. Raised before the tasks are pushed, so it never
+  // undercounts and a sleeping worker cannot miss work.
+  std::atomic<size_t> queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool stop_{false};
+
+  static inline thread_local const ThreadPool* current_pool_{nullptr};
+  static inline thread_local size_t current_queue_{0};
+
+};
+
+#endif /* thread_pool.hpp */
@@ -5,21 +5,36 @@
 #include <stdexcept>
 #include <iterator>
 #include <initializer_list>
+#include <algorithm>
+#include <memory>
+#include <bit>
 
 #include "error_msgs.hpp"
 #include "dynamic_storage.hpp"
 #include "static_storage.hpp"
 #include "chunked_storage.hpp"
+#include "small_storage.hpp"
+#include "allocators.hpp"
+#include "check_policies.hpp"
+#include "contiguous_iterator.hpp"
+#include "bit_ops.hpp"
+#include "rank_select.hpp"
 
 // BaseVectorIterator
 
 template<
   typename ElemT,
   template<typename StorageT, size_t StorageSize> class Storage,
-  size_t N
+  size_t N,
+  typename CheckPolicy
 >
 class Vector;
 
+template<typename StorageT>
+concept ContiguousStorage = requires(StorageT& storage) {
+  { storage.Buffer() } -> std::convertible_to<const void*>;
+};
+
 template<typename Vector, typename ElemT>
 class BaseVectorIterator {
  public:
@@ -194,20 +209,26 @@ class BaseVectorIterator {
 
  private:
   inline void CheckValid(const size_t index) const {
-    if (index != -1ULL && index > vector_->Size()) {
-      throw std::logic_error(INVALID_ITERATOR_MSG_);
+    if constexpr (Vector::check_policy::ENABLED) {
+      if (index != -1ULL && index > vector_->Size()) {
+        throw std::logic_error(INVALID_ITERATOR_MSG_);
+      }
     }
   }
 
   inline void CheckOverflow(const size_t index) const {
-    if (index >= vector_->Size()) {
-      throw std::out_of_range(OUT_OF_RANGE_MSG_);
+    if constexpr (Vector::check_policy::ENABLED) {
+      if (index >= vector_->Size()) {
+        throw std::out_of_range(OUT_OF_RANGE_MSG_);
+      }
     }
   }
 
   inline void CheckSameVectors(const BaseVectorIterator& other) const {
-    if (vector_ != other.vector_) {
-      throw std::logic_error(DIFFERENT_VECTORS_MSG_);
+    if constexpr (Vector::check_policy::ENABLED) {
+      if (vector_ != other.vector_) {
+        throw std::logic_error(DIFFERENT_VECTORS_MSG_);
+      }
     }
   }
 
@@ -235,10 +256,19 @@ using ConstVectorIterator = BaseVectorIterator<const Vector, const typename Vect
 
 // Vector
 
+// Selects the Vector constructor that passes its remaining arguments to the storage:
+// Vector<Record, MmapStorage> records(IN_PLACE_STORAGE, "records.bin");
+struct InPlaceStorage {
+  explicit InPlaceStorage() = default;
+};
+
+inline constexpr InPlaceStorage IN_PLACE_STORAGE{};
+
 template<
   typename ElemT,
   template<typename StorageT, size_t StorageSize> class Storage = DynamicStorage,
-  size_t N = 0
+  size_t N = 0,
+  typename CheckPolicy = AlwaysCheck
 >
 class Vector {
  public:
@@ -254,13 +284,26 @@ class Vector {
 
   using iterator_category = std::random_access_iterator_tag;
 
+  using check_policy = CheckPolicy;
+  using storage_type = Storage<ElemT, N>;
+
+  static constexpr bool IS_CONTIGUOUS = ContiguousStorage<storage_type>;
+
+  using iterator = std::conditional_t<IS_CONTIGUOUS,
+                                      ContiguousIterator<ElemT, CheckPolicy>,
+                                      VectorIterator<Vector>>;
+  using const_iterator = std::conditional_t<IS_CONTIGUOUS,
+                                            ContiguousIterator<const ElemT, CheckPolicy>,
+                                            ConstVectorIterator<Vector>>;
+
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
  public:
   Vector() = default;
 
   Vector(const std::initializer_list<ElemT>& init_list) {
-    for (const ElemT& value : init_list) {
-      new (storage_.ReserveBack()) ElemT(value);
-    }
+    Append(init_list.begin(), init_list.end());
   }
 
   explicit Vector(const size_t size) : storage_(size) {
@@ -269,6 +312,10 @@ class Vector {
   Vector(const size_t size, const ElemT& value) : storage_(size, value) {
   }
 
+  template<typename... ArgsT>
+  explicit Vector(InPlaceStorage, ArgsT&&... args) : storage_(std::forward<ArgsT>(args)...) {
+  }
+
   Vector(const Vector& other_copy) = default;
 
   Vector(Vector&& other_move) = default;
@@ -294,54 +341,75 @@ class Vector {
     return *this;
   }
 
-  inline ConstVectorIterator<Vector> cbegin() const {
-    return ConstVectorIterator<Vector>(this, 0);
+  inline const_iterator cbegin() const {
+    return MakeIterator(this, 0);
   }
 
-  inline ConstVectorIterator<Vector> cend() const {
-    return ConstVectorIterator<Vector>(this, Size());
+  inline const_iterator cend() const {
+    return MakeIterator(this, Size());
   }
 
-  inline VectorIterator<Vector> begin() {
-    return VectorIterator<Vector>(this, 0);
+  inline iterator begin() {
+    return MakeIterator(this, 0);
   }
 
-  inline ConstVectorIterator<Vector> begin() const {
+  inline const_iterator begin() const {
     return cbegin();
   }
 
-  inline VectorIterator<Vector> end() {
-    return VectorIterator<Vector>(this, Size());
+  inline iterator end() {
+    return MakeIterator(this, Size());
   }
 
-  inline ConstVectorIterator<Vector> end() const {
+  inline const_iterator end() const {
     return cend();
   }
 
-  inline std::reverse_iterator<ConstVectorIterator<Vector>> crbegin() const {
-    return std::make_reverse_iterator(ConstVectorIterator<Vector>(this, 0));
+  inline const_reverse_iterator crbegin() const {
+    return std::make_reverse_iterator(cend());
   }
 
-  inline std::reverse_iterator<ConstVectorIterator<Vector>> crend() const {
-    return std::make_reverse_iterator(ConstVectorIterator<Vector>(this, Size()));
+  inline const_reverse_iterator crend() const {
+    return std::make_reverse_iterator(cbegin());
   }
 
-  inline std::reverse_iterator<VectorIterator<Vector>> rbegin() {
-    return std::make_reverse_iterator(VectorIterator<Vector>(this, 0));
+  inline reverse_iterator rbegin() {
+    return std::make_reverse_iterator(end());
   }
 
-  inline std::reverse_iterator<VectorIterator<Vector>> rend() {
-    return std::make_reverse_iterator(VectorIterator<Vector>(this, Size()));
+  inline reverse_iterator rend() {
+    return std::make_reverse_iterator(begin());
   }
 
-  inline std::reverse_iterator<ConstVectorIterator<Vector>> rbegin() const {
+  inline const_reverse_iterator rbegin() const {
     return crbegin();
   }
 
-  inline std::reverse_iterator<ConstVectorIterator<Vector>> rend() const {
+  inline const_reverse_iterator rend() const {
     return crend();
   }
 
+  [[nodiscard]] inline ElemT* Data() noexcept requires IS_CONTIGUOUS {
+    return storage_.Buffer();
+  }
+
+  [[nodiscard]] inline const ElemT* Data() const noexcept requires IS_CONTIGUOUS {
+    return storage_.Buffer();
+  }
+
+  [[nodiscard]] inline const auto& GetAllocator() const
+    requires requires(const storage_type& storage) { storage.GetAllocator(); } {
+    return storage_.GetAllocator();
+  }
+
+  [[nodiscard]] inline storage_type& GetStorage() noexcept {
+    return storage_;
+  }
+
+  [[nodiscard]] inline const storage_type& GetStorage() const noexcept {
+    return storage_;
+  }
+
   [[nodiscard]] inline ElemT& At(const size_t index) noexcept {
     return storage_.At(index);
   }
@@ -351,8 +419,10 @@ class Vector {
   }
 
   [[nodiscard]] ElemT& operator[](const size_t index) {
-    if (index >= Size()) {
-      throw std::out_of_range(BAD_INDEX_MSG);
+    if constexpr (CheckPolicy::ENABLED) {
+      if (index >= Size()) {
+        throw std::out_of_range(BAD_INDEX_MSG);
+      }
     }
 
     return storage_.At(index);
@@ -394,6 +464,20 @@ class Vector {
     storage_.Resize(new_size);
   }
 
+  // New elements are default-initialized: class types run their default constructor,
+  // trivial ones are left unset instead of zeroed.
+  void ResizeDefaultInit(const size_t new_size) {
+    storage_.ResizeDefaultInit(new_size);
+  }
+
+  // New elements are left unset, to be overwritten right away (e.g. by read or a decoder).
+  void ResizeUninitialized(const size_t new_size) {
+    static_assert(std::is_trivially_default_constructible_v<ElemT> && std::is_trivially_destructible_v<ElemT>,
+                  "ResizeUninitialized needs a trivial element type");
+
+    storage_.ResizeDefaultInit(new_size);
+  }
+
   template<typename... ArgsT>
   void EmplaceBack(ArgsT&&... args) {
     storage_.ReserveBack();
@@ -418,32 +502,140 @@ class Vector {
     storage_.Resize(storage_.Size() - 1);
   }
 
+  void Reserve(const size_t capacity) {
+    storage_.Reserve(capacity);
+  }
+
+  // Appends [first, last). Forward ranges reserve once and are constructed in bulk.
+  template<typename InputIt>
+  void Append(InputIt first, InputIt last) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (!std::is_base_of_v<std::forward_iterator_tag, Category>) {
+      for (; first != last; ++first) {
+        EmplaceBack(*first);
+      }
+    } else if constexpr (IS_CONTIGUOUS) {
+      const size_t count = std::distance(first, last);
+      ElemT* dst = storage_.ReserveBack(count);
+      try {
+        std::uninitialized_copy(first, last, dst);
+      } catch (...) {
+        storage_.RollBackReservedBack(count);
+        throw;
+      }
+    } else {
+      storage_.Reserve(Size() + std::distance(first, last));
+      for (; first != last; ++first) {
+        EmplaceBack(*first);
+      }
+    }
+  }
+
+  // Inserts [first, last) before pos and returns an iterator to the first inserted element.
+  template<typename InputIt>
+  iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+    const size_t index = pos - cbegin();
+    const size_t old_size = Size();
+    Append(first, last);
+    std::rotate(begin() + index, begin() + old_size, end());
+    return begin() + index;
+  }
+
+  // Erases [first, last) and returns an iterator to the element that followed it.
+  iterator Erase(const_iterator first, const_iterator last) {
+    const size_t first_index = first - cbegin();
+    const size_t last_index = last - cbegin();
+    if (first_index != last_index) {
+      std::move(begin() + last_index, end(), begin() + first_index);
+      storage_.Resize(Size() - (last_index - first_index));
+    }
+    return begin() + first_index;
+  }
+
+  // Replaces the contents with count copies of value.
+  void AssignN(const size_t count, const ElemT& value) {
+    storage_.Resize(0);
+    if constexpr (IS_CONTIGUOUS) {
+      ElemT* dst = storage_.ReserveBack(count);
+      try {
+        std::uninitialized_fill_n(dst, count, value);
+      } catch (...) {
+        storage_.RollBackReservedBack(count);
+        throw;
+      }
+    } else {
+      storage_.Reserve(count);
+      for (size_t i = 0; i < count; ++i) {
+        EmplaceBack(value);
+      }
+    }
+  }
+
   void Shrink() {
     storage_.Shrink();
   }
 
+  // Calls func(data, count) for each contiguous run of elements in index order.
+  // func may return false to stop early; the result tells whether the walk finished.
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) {
+    return storage_.ForEachSegment(std::forward<FuncT>(func));
+  }
+
+  template<typename FuncT>
+  bool ForEachSegment(FuncT&& func) const {
+    return storage_.ForEachSegment(std::forward<FuncT>(func));
+  }
+
+ private:
+  template<typename VectorT>
+  static inline auto MakeIterator(VectorT* vector, const size_t index) {
+    using ResultT = std::conditional_t<std::is_const_v<VectorT>, const_iterator, iterator>;
+    if constexpr (IS_CONTIGUOUS) {
+      auto* data = vector->storage_.Buffer();
+      return ResultT(data + index, data, data + vector->Size());
+    } else {
+      return ResultT(vector, index);
+    }
+  }
+
  private:
   Storage<ElemT, N> storage_;
 
 };
 
+template<
+  typename ElemT,
+  template<typename StorageT, size_t StorageSize> class Storage,
+  size_t N,
+  typename CheckPolicy
+>
+struct IsTriviallyRelocatable<Vector<ElemT, Storage, N, CheckPolicy>> : IsTriviallyRelocatable<Storage<ElemT, N>> {
+};
+
 class BoolProxy {
-  public:
-  BoolProxy(uint8_t& byte, uint8_t bit) : byte_(byte), bit_(bit) {
+ public:
+  using Word = uint64_t;
+
+ public:
+  // Every write through the proxy increments *mutations, when it is given.
+  BoolProxy(Word& word, uint8_t bit, uint64_t* mutations = nullptr) : word_(word), bit_(bit), mutations_(mutations) {
     assert(bit < BITS_CNT_);
   }
 
-  BoolProxy(const BoolProxy& other_copy) : byte_(other_copy.byte_), bit_(other_copy.bit_) {}
-  BoolProxy(BoolProxy&& other_move) : byte_(other_move.byte_), bit_(other_move.bit_) {}
+  BoolProxy(const BoolProxy& other_copy) :
+    word_(other_copy.word_), bit_(other_copy.bit_), mutations_(other_copy.mutations_) {}
+  BoolProxy(BoolProxy&& other_move) :
+    word_(other_move.word_), bit_(other_move.bit_), mutations_(other_move.mutations_) {}
 
   inline bool GetValue() const noexcept {
-    return (byte_ >> bit_) & 0x1;
+    return (word_ >> bit_) & 0x1;
   }
 
   void SetValue(bool value) {
-    byte_ &= ~(1 << bit_);
-    if (value) {
-      byte_ |= (1 << bit_);
+    word_ = (word_ & ~(Word{1} << bit_)) | (Word{value} << bit_);
+    if (mutations_ != nullptr) {
+      ++*mutations_;
     }
   }
 
@@ -467,23 +659,109 @@ class BoolProxy {
   }
 
  private:
-  uint8_t& byte_;
+  Word& word_;
   const uint8_t bit_;
+  uint64_t* const mutations_;
 
  public:
-  static const size_t BITS_CNT_ = 8;
-  static const size_t OFFSET_   = 3;
+  static const size_t BITS_CNT_ = 64;
+  static const size_t OFFSET_   = 6;
+
+};
+
+// SetBitIterator
+
+// Walks the indices of the set bits of a Vector<bool> a word at a time:
+// ctz finds the next bit, clearing the lowest bit advances.
+template<typename BoolVector>
+class SetBitIterator {
+ public:
+  using Word = BoolProxy::Word;
+
+  using iterator_category = std::forward_iterator_tag;
+
+  using value_type      = size_t;
+  using pointer         = const size_t*;
+  using reference       = size_t;
+  using difference_type = std::ptrdiff_t;
+
+ public:
+  SetBitIterator() = default;
+
+  SetBitIterator(const BoolVector* vector, const size_t word_num) : vector_{vector}, word_num_{word_num} {
+    if (word_num_ < vector_->WordsCnt()) {
+      word_ = vector_->GetWord(word_num_);
+      SkipEmptyWords();
+    }
+  }
+
+  inline size_t operator*() const {
+    return word_num_ * BoolProxy::BITS_CNT_ + std::countr_zero(word_);
+  }
+
+  inline SetBitIterator& operator++() {
+    word_ &= word_ - 1;
+    SkipEmptyWords();
+    return *this;
+  }
+
+  inline SetBitIterator operator++(int) {
+    SetBitIterator old(*this);
+    this->operator++();
+    return old;
+  }
+
+  inline bool operator==(const SetBitIterator& rhs) const {
+    return word_num_ == rhs.word_num_ && word_ == rhs.word_;
+  }
+
+ private:
+  inline void SkipEmptyWords() {
+    const size_t words_cnt = vector_->WordsCnt();
+    while (word_ == 0 && ++word_num_ < words_cnt) {
+      word_ = vector_->GetWord(word_num_);
+    }
+    if (word_ == 0) {
+      word_num_ = words_cnt;
+    }
+  }
+
+ private:
+  const BoolVector* vector_{nullptr};
+  size_t word_num_{0};
+  Word word_{0};
+
+};
+
+template<typename BoolVector>
+class SetBitsRange {
+ public:
+  explicit SetBitsRange(const BoolVector* vector) : vector_{vector} {
+  }
+
+  inline SetBitIterator<BoolVector> begin() const {
+    return SetBitIterator<BoolVector>(vector_, 0);
+  }
+
+  inline SetBitIterator<BoolVector> end() const {
+    return SetBitIterator<BoolVector>(vector_, vector_->WordsCnt());
+  }
+
+ private:
+  const BoolVector* vector_;
 
 };
 
 
 // bool sepcialization
 
+// Bits are packed into 64-bit words; bits past Size() in the last word are always zero.
 template<
   template<typename StorageT, size_t StorageSize> class Storage,
-  size_t N
+  size_t N,
+  typename CheckPolicy
 >
-class Vector<bool, Storage, N> {
+class Vector<bool, Storage, N, CheckPolicy> {
  public:
   using value_type = bool;
 
@@ -497,6 +775,13 @@ class Vector<bool, Storage, N> {
 
   using iterator_category = std::random_access_iterator_tag;
 
+  using check_policy = CheckPolicy;
+
+  using iterator       = VectorIterator<Vector>;
+  using const_iterator = ConstVectorIterator<Vector>;
+
+  using Word = BoolProxy::Word;
+
  public:
   Vector() = default;
 
@@ -509,7 +794,14 @@ class Vector<bool, Storage, N> {
   explicit Vector(const size_t size) : storage_(CalcSize(size)), size_{size} {
   }
 
-  Vector(const Vector& other_copy) = default;
+  Vector(const size_t size, const bool value) : storage_(CalcSize(size)), size_{size} {
+    if (value) {
+      FillBits(0, size_, true);
+    }
+  }
+
+  Vector(const Vector& other_copy) : storage_(other_copy.storage_), size_{other_copy.size_} {
+  }
 
   Vector(Vector&& other_move) = default;
 
@@ -540,19 +832,19 @@ class Vector<bool, Storage, N> {
   }
 
   inline std::reverse_iterator<ConstVectorIterator<Vector>> crbegin() const {
-    return std::make_reverse_iterator(ConstVectorIterator<Vector>(this, 0));
+    return std::make_reverse_iterator(ConstVectorIterator<Vector>(this, Size()));
   }
 
   inline std::reverse_iterator<ConstVectorIterator<Vector>> crend() const {
-    return std::make_reverse_iterator(ConstVectorIterator<Vector>(this, Size()));
+    return std::make_reverse_iterator(ConstVectorIterator<Vector>(this, 0));
   }
 
   inline std::reverse_iterator<VectorIterator<Vector>> rbegin() {
-    return std::make_reverse_iterator(VectorIterator<Vector>(this, 0));
+    return std::make_reverse_iterator(VectorIterator<Vector>(this, Size()));
   }
 
   inline std::reverse_iterator<VectorIterator<Vector>> rend() {
-    return std::make_reverse_iterator(VectorIterator<Vector>(this, Size()));
+    return std::make_reverse_iterator(VectorIterator<Vector>(this, 0));
   }
 
   inline std::reverse_iterator<ConstVectorIterator<Vector>> rbegin() const {
@@ -563,6 +855,11 @@ class Vector<bool, Storage, N> {
     return crend();
   }
 
+  // Indices of the set bits in increasing order.
+  inline SetBitsRange<Vector> SetBits() const {
+    return SetBitsRange<Vector>(this);
+  }
+
   Vector& operator=(const Vector& other_copy) {
     if (this == &other_copy) {
       return *this;
@@ -579,34 +876,50 @@ class Vector<bool, Storage, N> {
     }
 
     Vector tmp(std::move(other_move));
-    SwapFields(other_move);
+    SwapFields(tmp);
     return *this;
   }
 
   [[nodiscard]] inline BoolProxy At(const size_t index) noexcept {
-    return BoolProxy(storage_.At(index >> OFFSET_), index % BITS_CNT_);
+    return BoolProxy(storage_.At(index >> OFFSET_), index % BITS_CNT_, &mutations_);
   }
 
   [[nodiscard]] inline const BoolProxy At(const size_t index) const noexcept {
-    return const_cast<Vector*>(this)->At(index);
+    return BoolProxy(const_cast<Word&>(storage_.At(index >> OFFSET_)), index % BITS_CNT_, &mutations_);
   }
 
   [[nodiscard]] inline BoolProxy operator[](const size_t index) {
-    if (index >= size_) {
-      throw std::out_of_range(BAD_INDEX_MSG);
+    if constexpr (CheckPolicy::ENABLED) {
+      if (index >= size_) {
+        throw std::out_of_range(BAD_INDEX_MSG);
+      }
     }
 
     return At(index);
   }
 
   [[nodiscard]] inline const BoolProxy operator[](const size_t index) const {
-    return const_cast<Vector*>(this)->operator[](index);
+    if constexpr (CheckPolicy::ENABLED) {
+      if (index >= size_) {
+        throw std::out_of_range(BAD_INDEX_MSG);
+      }
+    }
+
+    return At(index);
   }
 
   [[nodiscard]] inline size_t Size() const noexcept {
     return size_;
   }
 
+  [[nodiscard]] inline size_t WordsCnt() const noexcept {
+    return storage_.Size();
+  }
+
+  [[nodiscard]] inline Word GetWord(const size_t word_num) const noexcept {
+    return storage_.At(word_num);
+  }
+
   [[nodiscard]] inline BoolProxy Front() {
     if (size_ == 0) {
       throw std::logic_error(BAD_FRONT_MSG);
@@ -619,19 +932,35 @@ class Vector<bool, Storage, N> {
     return const_cast<Vector*>(this)->Front();
   }
 
+  [[nodiscard]] inline BoolProxy Back() {
+    if (size_ == 0) {
+      throw std::logic_error(BAD_BACK_MSG);
+    }
+
+    return At(size_ - 1);
+  }
+
+  [[nodiscard]] inline const BoolProxy Back() const {
+    return const_cast<Vector*>(this)->Back();
+  }
+
   void Resize(const size_t new_size) {
-    storage_.Resize(CalcSize(new_size));
+    Words().Resize(CalcSize(new_size));
+    size_ = new_size;
+    ClearTail();
   }
 
   void EmplaceBack(bool value) {
-    storage_.Resize(CalcSize(size_ + 1));
+    if (size_ % BITS_CNT_ == 0) {
+      Words().Resize(CalcSize(size_ + 1));
+    }
     size_++;
 
     At(size_ - 1) = value;
   }
 
   void PushBack(bool value) {
-    PushBack(value);
+    EmplaceBack(value);
   }
 
   void PopBack() {
@@ -639,17 +968,344 @@ class Vector<bool, Storage, N> {
       throw std::logic_error(BAD_POP_MSG);
     }
 
-    storage_.Resize(size_ - 1);
+    At(size_ - 1) = false;
+    --size_;
+    Words().Resize(CalcSize(size_));
   }
 
   void Shrink() {
     storage_.Shrink();
   }
 
+  template<typename FuncT>
+  bool ForEachWordSegment(FuncT&& func) {
+    return Words().ForEachSegment(std::forward<FuncT>(func));
+  }
+
+  template<typename FuncT>
+  bool ForEachWordSegment(FuncT&& func) const {
+    return storage_.ForEachSegment(std::forward<FuncT>(func));
+  }
+
+  // Bit queries
+
+  [[nodiscard]] size_t Count() const {
+    size_t count = 0;
+    ForEachWordSegment([&count](const Word* words, const size_t words_cnt) {
+      count += PopcountWords(words, words_cnt);
+    });
+    return count;
+  }
+
+  [[nodiscard]] bool Any() const {
+    return !ForEachWordSegment([](const Word* words, const size_t words_cnt) {
+      for (size_t i = 0; i < words_cnt; ++i) {
+        if (words[i] != 0) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+  [[nodiscard]] bool None() const {
+    return !Any();
+  }
+
+  [[nodiscard]] bool All() const {
+    return FindFirst(false) == size_;
+  }
+
+  // Index of the first bit equal to value, or Size() if there is none.
+  [[nodiscard]] size_t FindFirst(const bool value) const {
+    return FindFrom(value, 0);
+  }
+
+  // Index of the first bit after pos equal to value, or Size() if there is none.
+  [[nodiscard]] size_t FindNext(const bool value, const size_t pos) const {
+    return pos + 1 >= size_ ? size_ : FindFrom(value, pos + 1);
+  }
+
+  // Sorting bits is counting them: all zeros first, then all ones.
+  void Sort() {
+    const size_t ones_cnt = Count();
+    FillBits(0, size_ - ones_cnt, false);
+    FillBits(size_ - ones_cnt, size_, true);
+  }
+
+  // Rank/select queries use an index built on first use and rebuilt on the first query after
+  // the bits change, so concurrent const queries need external synchronization. Writes
+  // through BoolProxy count as changes, and so does any call to the non-const
+  // ForEachWordSegment, which hands out writable words.
+
+  // Set bits in [0, index), index <= Size().
+  [[nodiscard]] size_t Rank1(const size_t index) const {
+    if constexpr (CheckPolicy::ENABLED) {
+      if (index > size_) {
+        throw std::out_of_range(BAD_INDEX_MSG);
+      }
+    }
+
+    return RankIndex().Rank1(*this, index);
+  }
+
+  // Unset bits in [0, index), index <= Size().
+  [[nodiscard]] size_t Rank0(const size_t index) const {
+    return index - Rank1(index);
+  }
+
+  // Index of the k-th set bit counting from zero, or Size() if there are not that many.
+  [[nodiscard]] size_t Select1(const size_t k) const {
+    const RankSelectIndex& index = RankIndex();
+    return k < index.Ones() ? index.Select1(*this, k) : size_;
+  }
+
+  // Frees the rank/select index until the next query.
+  void ReleaseRankIndex() {
+    rank_index_.reset();
+  }
+
+  // Bulk bitwise operations, a word at a time. Binary ones need operands of the same size.
+
+  Vector& And(const Vector& other) {
+    return ApplyWords<BitOp::AND>(other);
+  }
+
+  Vector& Or(const Vector& other) {
+    return ApplyWords<BitOp::OR>(other);
+  }
+
+  Vector& Xor(const Vector& other) {
+    return ApplyWords<BitOp::XOR>(other);
+  }
+
+  Vector& AndNot(const Vector& other) {
+    return ApplyWords<BitOp::AND_NOT>(other);
+  }
+
+  Vector& Not() {
+    ForEachWordSegment([](Word* words, const size_t words_cnt) {
+      BitNotWords(words, words_cnt);
+    });
+    ClearTail();
+    return *this;
+  }
+
+  // Sets bits [first, last).
+  Vector& SetRange(const size_t first, const size_t last) {
+    CheckRange(first, last);
+    FillBits(first, last, true);
+    return *this;
+  }
+
+  // Clears bits [first, last).
+  Vector& ClearRange(const size_t first, const size_t last) {
+    CheckRange(first, last);
+    FillBits(first, last, false);
+    return *this;
+  }
+
+  // Moves bit i to i + shift, like std::bitset::operator<<=. Bits shifted past Size() are lost.
+  Vector& ShiftLeft(const size_t shift) {
+    if (shift >= size_) {
+      return ClearRange(0, size_);
+    }
+
+    const size_t word_shift = shift >> OFFSET_;
+    const size_t bit_shift = shift % BITS_CNT_;
+    for (size_t i = WordsCnt(); i-- > word_shift;) {
+      Word word = Words().At(i - word_shift) << bit_shift;
+      if (bit_shift != 0 && i > word_shift) {
+        word |= Words().At(i - word_shift - 1) >> (BITS_CNT_ - bit_shift);
+      }
+      Words().At(i) = word;
+    }
+    FillBits(0, shift, false);
+    ClearTail();
+    return *this;
+  }
+
+  // Moves bit i to i - shift, like std::bitset::operator>>=.
+  Vector& ShiftRight(const size_t shift) {
+    if (shift >= size_) {
+      return ClearRange(0, size_);
+    }
+
+    const size_t words_cnt = WordsCnt();
+    const size_t word_shift = shift >> OFFSET_;
+    const size_t bit_shift = shift % BITS_CNT_;
+    for (size_t i = 0; i + word_shift < words_cnt; ++i) {
+      Word word = Words().At(i + word_shift) >> bit_shift;
+      if (bit_shift != 0 && i + word_shift + 1 < words_cnt) {
+        word |= Words().At(i + word_shift + 1) << (BITS_CNT_ - bit_shift);
+      }
+      Words().At(i) = word;
+    }
+    FillBits(size_ - shift, size_, false);
+    return *this;
+  }
+
+  Vector& operator&=(const Vector& other) {
+    return And(other);
+  }
+
+  Vector& operator|=(const Vector& other) {
+    return Or(other);
+  }
+
+  Vector& operator^=(const Vector& other) {
+    return Xor(other);
+  }
+
+  Vector& operator<<=(const size_t shift) {
+    return ShiftLeft(shift);
+  }
+
+  Vector& operator>>=(const size_t shift) {
+    return ShiftRight(shift);
+  }
+
+  friend Vector operator&(Vector lhs, const Vector& rhs) {
+    return std::move(lhs.And(rhs));
+  }
+
+  friend Vector operator|(Vector lhs, const Vector& rhs) {
+    return std::move(lhs.Or(rhs));
+  }
+
+  friend Vector operator^(Vector lhs, const Vector& rhs) {
+    return std::move(lhs.Xor(rhs));
+  }
+
+  friend Vector AndNot(Vector lhs, const Vector& rhs) {
+    return std::move(lhs.AndNot(rhs));
+  }
+
+  friend Vector operator~(Vector vector) {
+    return std::move(vector.Not());
+  }
+
+  friend Vector operator<<(Vector vector, const size_t shift) {
+    return std::move(vector.ShiftLeft(shift));
+  }
+
+  friend Vector operator>>(Vector vector, const size_t shift) {
+    return std::move(vector.ShiftRight(shift));
+  }
+
  private:
+  // Storages of the same type split words into segments at the same indices, so the
+  // matching words of other are contiguous for the whole segment.
+  template<BitOp Op>
+  Vector& ApplyWords(const Vector& other) {
+    if (other.size_ != size_) {
+      throw std::invalid_argument(BAD_SIZE_MISMATCH);
+    }
+
+    size_t offset = 0;
+    ForEachWordSegment([&offset, &other](Word* words, const size_t words_cnt) {
+      BitOpWords<Op>(words, &other.storage_.At(offset), words_cnt);
+      offset += words_cnt;
+    });
+    return *this;
+  }
+
+  // Calls func(words, count) for the parts of word segments inside [first_word, last_word).
+  template<typename FuncT>
+  void ForEachWordRange(const size_t first_word, const size_t last_word, FuncT&& func) {
+    size_t offset = 0;
+    ForEachWordSegment([&](Word* words, const size_t words_cnt) {
+      const size_t begin = std::max(offset, first_word);
+      const size_t end = std::min(offset + words_cnt, last_word);
+      if (begin < end) {
+        func(words + (begin - offset), end - begin);
+      }
+      offset += words_cnt;
+      return offset < last_word;
+    });
+  }
+
+  // The storage, for methods that write words directly.
+  inline auto& Words() noexcept {
+    ++mutations_;
+    return storage_;
+  }
+
+  const RankSelectIndex& RankIndex() const {
+    if (rank_index_ == nullptr || rank_index_mutations_ != mutations_) {
+      if (rank_index_ == nullptr) {
+        rank_index_ = std::make_unique<RankSelectIndex>();
+      }
+      rank_index_->Build(*this);
+      rank_index_mutations_ = mutations_;
+    }
+    return *rank_index_;
+  }
+
+  void CheckRange(const size_t first, const size_t last) const {
+    if (first > last || last > size_) {
+      throw std::out_of_range(BAD_RANGE_MSG);
+    }
+  }
+
+  size_t FindFrom(const bool value, const size_t first) const {
+    const size_t words_cnt = WordsCnt();
+    const Word flip = value ? 0 : ~Word{0};
+
+    size_t word_num = first >> OFFSET_;
+    if (word_num >= words_cnt) {
+      return size_;
+    }
+
+    Word word = (GetWord(word_num) ^ flip) & (~Word{0} << (first % BITS_CNT_));
+    while (word == 0) {
+      if (++word_num == words_cnt) {
+        return size_;
+      }
+      word = GetWord(word_num) ^ flip;
+    }
+
+    return std::min(size_, word_num * BITS_CNT_ + std::countr_zero(word));
+  }
+
+  void FillBits(const size_t first, const size_t last, const bool value) {
+    if (first >= last) {
+      return;
+    }
+
+    const size_t first_word = first >> OFFSET_;
+    const size_t last_word = (last - 1) >> OFFSET_;
+    const Word first_mask = ~Word{0} << (first % BITS_CNT_);
+    const Word last_mask = ~Word{0} >> (BITS_CNT_ - 1 - (last - 1) % BITS_CNT_);
+
+    if (first_word == last_word) {
+      SetMasked(Words().At(first_word), first_mask & last_mask, value);
+      return;
+    }
+
+    SetMasked(Words().At(first_word), first_mask, value);
+    ForEachWordRange(first_word + 1, last_word, [value](Word* words, const size_t words_cnt) {
+      BitFillWords(words, words_cnt, value ? ~Word{0} : 0);
+    });
+    SetMasked(Words().At(last_word), last_mask, value);
+  }
+
+  static inline void SetMasked(Word& word, const Word mask, const bool value) {
+    word = value ? (word | mask) : (word & ~mask);
+  }
+
+  void ClearTail() {
+    if (size_ % BITS_CNT_ != 0) {
+      Words().At(size_ >> OFFSET_) &= ~(~Word{0} << (size_ % BITS_CNT_));
+    }
+  }
+
   void SwapFields(Vector& other) {
     std::swap(storage_, other.storage_);
     std::swap(size_, other.size_);
+    std::swap(rank_index_, other.rank_index_);
+    std::swap(mutations_, other.mutations_);
+    std::swap(rank_index_mutations_, other.rank_index_mutations_);
   }
 
   static constexpr inline size_t CalcSize(const size_t size) {
@@ -660,13 +1316,19 @@ class Vector<bool, Storage, N> {
   static const size_t BITS_CNT_ = BoolProxy::BITS_CNT_;
   static const size_t OFFSET_   = BoolProxy::OFFSET_;
 
-  Storage<uint8_t, CalcSize(N)> storage_;
+  Storage<Word, CalcSize(N)> storage_;
   size_t size_{0};
 
+  // Writes so far, and how many there had been when the rank/select index was built.
+  // Proxies of a const Vector can still be copied into writable ones, so they count too.
+  mutable uint64_t mutations_{0};
+  mutable std::unique_ptr<RankSelectIndex> rank_index_;
+  mutable uint64_t rank_index_mutations_{0};
+
 };
 
-void swap(BoolProxy a, BoolProxy b) {
-  BoolProxy tmp = a;
+inline void swap(BoolProxy a, BoolProxy b) {
+  bool tmp = a;
   a = b;
   b = tmp;
 }
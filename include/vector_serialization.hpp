@@ -0,0 +1,390 @@
+#ifndef VECTOR_SERIALIZATION_HPP
+#define VECTOR_SERIALIZATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+
+#include <sys/uio.h>
+
+#include "vector.hpp"
+#include "mapped_region.hpp"
+#include "error_msgs.hpp"
+
+// Binary format for Vector<T> and Vector<Vector<T>> with trivially copyable T, in host byte
+// order. A 64-byte header is followed by the elements, aligned for T, so a buffer that was
+// read or mapped whole can be used in place through View:
+//   flat:   header | values[count]
+//   nested: header | offsets[count + 1] (uint64_t) | values[values_count]
+// WriteTo gathers the storage segments with writev, and ReadFrom scatters straight into the
+// resized vector with readv; neither stages elements.
+
+enum class SerializedType : uint32_t {
+  Unsigned = 1,
+  Signed = 2,
+  Float = 3,
+  Bytes = 4
+};
+
+enum class SerializedLayout : uint32_t {
+  Flat = 1,
+  Nested = 2
+};
+
+struct SerializedHeader {
+  static constexpr uint64_t MAGIC = 0x3152455343455656ull; // "VVECSER1"
+  static constexpr uint32_t VERSION = 1;
+  static constexpr size_t BYTES = 64;
+
+  uint64_t magic;
+  uint32_t version;
+  uint32_t layout;
+  uint32_t type_tag;
+  uint32_t elem_size;
+  uint32_t elem_align;
+  uint32_t reserved;
+  uint64_t count;
+  uint64_t values_count;
+};
+
+static_assert(sizeof(SerializedHeader) <= SerializedHeader::BYTES);
+
+template<typename T>
+struct IsVectorType : std::false_type {
+};
+
+template<
+  typename ElemT,
+  template<typename StorageT, size_t StorageSize> class Storage,
+  size_t N,
+  typename CheckPolicy
+>
+struct IsVectorType<Vector<ElemT, Storage, N, CheckPolicy>> : std::true_type {
+};
+
+template<typename VectorT>
+concept FlatSerializable = IsVectorType<VectorT>::value &&
+                           std::is_trivially_copyable_v<typename VectorT::value_type> &&
+                           !std::is_same_v<typename VectorT::value_type, bool> &&
+                           alignof(typename VectorT::value_type) <= SerializedHeader::BYTES;
+
+template<typename VectorT>
+concept NestedSerializable = IsVectorType<VectorT>::value && FlatSerializable<typename VectorT::value_type>;
+
+template<typename ElemT>
+constexpr SerializedType SERIALIZED_TYPE = std::is_floating_point_v<ElemT> ? SerializedType::Float :
+                                           std::is_signed_v<ElemT> && std::is_integral_v<ElemT> ? SerializedType::Signed :
+                                           std::is_integral_v<ElemT> ? SerializedType::Unsigned :
+                                           SerializedType::Bytes;
+
+inline size_t AlignSerialized(const size_t offset, const size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+template<typename ElemT>
+inline size_t SerializedValuesOffset(const SerializedLayout layout, const size_t count) {
+  const size_t offsets_end = SerializedHeader::BYTES +
+                             (layout == SerializedLayout::Nested ? (count + 1) * sizeof(uint64_t) : 0);
+  return AlignSerialized(offsets_end, alignof(ElemT));
+}
+
+template<typename ElemT>
+SerializedHeader MakeSerializedHeader(const SerializedLayout layout, const size_t count, const size_t values_count) {
+  return SerializedHeader{SerializedHeader::MAGIC, SerializedHeader::VERSION,
+                          static_cast<uint32_t>(layout), static_cast<uint32_t>(SERIALIZED_TYPE<ElemT>),
+                          sizeof(ElemT), alignof(ElemT), 0, count, values_count};
+}
+
+template<typename ElemT>
+void CheckSerializedHeader(const SerializedHeader& header, const SerializedLayout layout) {
+  if (header.magic != SerializedHeader::MAGIC || header.version != SerializedHeader::VERSION ||
+      header.layout != static_cast<uint32_t>(layout) ||
+      header.type_tag != static_cast<uint32_t>(SERIALIZED_TYPE<ElemT>) ||
+      header.elem_size != sizeof(ElemT) || header.elem_align != alignof(ElemT)) {
+    throw std::runtime_error(BAD_SERIALIZED_MSG);
+  }
+}
+
+// The iovecs of one WriteTo or ReadFrom call, in file order. Padding is written from a
+// zeroed block and read back into it.
+class IoVectors {
+ public:
+  void Add(const void* data, const size_t bytes) {
+    if (bytes != 0) {
+      iovecs_.PushBack(iovec{const_cast<void*>(data), bytes});
+      bytes_ += bytes;
+    }
+  }
+
+  void AddPadding(const size_t bytes) {
+    assert(bytes <= sizeof(padding_));
+    Add(padding_, bytes);
+  }
+
+  [[nodiscard]] inline size_t Bytes() const {
+    return bytes_;
+  }
+
+  void WriteAll(const int fd) {
+    Transfer(fd, [](const int fd_, const iovec* iov, const int count) {
+      return writev(fd_, iov, count);
+    }, "writev");
+  }
+
+  void ReadAll(const int fd) {
+    Transfer(fd, [](const int fd_, const iovec* iov, const int count) {
+      return readv(fd_, iov, count);
+    }, "readv");
+  }
+
+ private:
+  template<typename CallT>
+  void Transfer(const int fd, CallT&& call, const char* what) {
+    size_t first = 0;
+    while (first < iovecs_.Size()) {
+      const int count = static_cast<int>(std::min<size_t>(iovecs_.Size() - first, IOV_MAX));
+      const ssize_t done = call(fd, &iovecs_[first], count);
+      if (done < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        ThrowErrno(what);
+      }
+      if (done == 0) {
+        throw std::runtime_error(BAD_SERIALIZED_SIZE_MSG);
+      }
+
+      size_t left = static_cast<size_t>(done);
+      while (first < iovecs_.Size() && left >= iovecs_[first].iov_len) {
+        left -= iovecs_[first].iov_len;
+        ++first;
+      }
+      if (left != 0) {
+        iovecs_[first].iov_base = static_cast<char*>(iovecs_[first].iov_base) + left;
+        iovecs_[first].iov_len -= left;
+      }
+    }
+  }
+
+ private:
+  Vector<iovec> iovecs_;
+  size_t bytes_{0};
+
+  alignas(64) unsigned char padding_[SerializedHeader::BYTES]{};
+
+};
+
+template<typename VectorT>
+void AddSegments(IoVectors& iovecs, VectorT& vector) {
+  vector.ForEachSegment([&iovecs](auto* data, const size_t count) {
+    iovecs.Add(data, count * sizeof(*data));
+  });
+}
+
+template<FlatSerializable VectorT>
+[[nodiscard]] size_t SerializedBytes(const VectorT& vector) {
+  using ElemT = typename VectorT::value_type;
+  return SerializedValuesOffset<ElemT>(SerializedLayout::Flat, vector.Size()) + vector.Size() * sizeof(ElemT);
+}
+
+template<NestedSerializable VectorT>
+[[nodiscard]] size_t SerializedBytes(const VectorT& vector) {
+  using ElemT = typename VectorT::value_type::value_type;
+  size_t values_count = 0;
+  for (const auto& inner : vector) {
+    values_count += inner.Size();
+  }
+  return SerializedValuesOffset<ElemT>(SerializedLayout::Nested, vector.Size()) + values_count * sizeof(ElemT);
+}
+
+template<FlatSerializable VectorT>
+void WriteTo(const int fd, const VectorT& vector) {
+  using ElemT = typename VectorT::value_type;
+  const SerializedHeader header = MakeSerializedHeader<ElemT>(SerializedLayout::Flat, vector.Size(), vector.Size());
+
+  IoVectors iovecs;
+  iovecs.Add(&header, sizeof(header));
+  iovecs.AddPadding(SerializedValuesOffset<ElemT>(SerializedLayout::Flat, vector.Size()) - sizeof(header));
+  AddSegments(iovecs, vector);
+  iovecs.WriteAll(fd);
+}
+
+// Only the offsets are built up front; the values go out from the inner vectors' own memory.
+template<NestedSerializable VectorT>
+void WriteTo(const int fd, const VectorT& vector) {
+  using ElemT = typename VectorT::value_type::value_type;
+  Vector<uint64_t> offsets;
+  offsets.ResizeDefaultInit(vector.Size() + 1);
+  offsets[0] = 0;
+  for (size_t i = 0; i < vector.Size(); ++i) {
+    offsets[i + 1] = offsets[i] + vector[i].Size();
+  }
+  const SerializedHeader header = MakeSerializedHeader<ElemT>(SerializedLayout::Nested, vector.Size(),
+                                                              offsets[vector.Size()]);
+
+  IoVectors iovecs;
+  iovecs.Add(&header, sizeof(header));
+  iovecs.AddPadding(SerializedHeader::BYTES - sizeof(header));
+  iovecs.Add(offsets.Data(), offsets.Size() * sizeof(uint64_t));
+  iovecs.AddPadding(SerializedValuesOffset<ElemT>(SerializedLayout::Nested, vector.Size()) - iovecs.Bytes());
+  for (const auto& inner : vector) {
+    AddSegments(iovecs, inner);
+  }
+  iovecs.WriteAll(fd);
+}
+
+inline SerializedHeader ReadSerializedHeader(const int fd) {
+  SerializedHeader header;
+  IoVectors iovecs;
+  iovecs.Add(&header, sizeof(header));
+  iovecs.AddPadding(SerializedHeader::BYTES - sizeof(header));
+  iovecs.ReadAll(fd);
+  return header;
+}
+
+template<FlatSerializable VectorT>
+[[nodiscard]] VectorT ReadFrom(const int fd) {
+  using ElemT = typename VectorT::value_type;
+  const SerializedHeader header = ReadSerializedHeader(fd);
+  CheckSerializedHeader<ElemT>(header, SerializedLayout::Flat);
+
+  VectorT vector;
+  vector.ResizeDefaultInit(header.count);
+  IoVectors iovecs;
+  iovecs.AddPadding(SerializedValuesOffset<ElemT>(SerializedLayout::Flat, header.count) - SerializedHeader::BYTES);
+  AddSegments(iovecs, vector);
+  iovecs.ReadAll(fd);
+  return vector;
+}
+
+template<NestedSerializable VectorT>
+[[nodiscard]] VectorT ReadFrom(const int fd) {
+  using ElemT = typename VectorT::value_type::value_type;
+  const SerializedHeader header = ReadSerializedHeader(fd);
+  CheckSerializedHeader<ElemT>(header, SerializedLayout::Nested);
+
+  Vector<uint64_t> offsets;
+  offsets.ResizeDefaultInit(header.count + 1);
+  IoVectors offsets_iovecs;
+  AddSegments(offsets_iovecs, offsets);
+  offsets_iovecs.ReadAll(fd);
+  if (offsets[0] != 0 || offsets[header.count] != header.values_count ||
+      !std::is_sorted(offsets.begin(), offsets.end())) {
+    throw std::runtime_error(BAD_SERIALIZED_MSG);
+  }
+
+  VectorT vector(header.count);
+  IoVectors iovecs;
+  iovecs.AddPadding(SerializedValuesOffset<ElemT>(SerializedLayout::Nested, header.count) -
+                    SerializedHeader::BYTES - offsets.Size() * sizeof(uint64_t));
+  for (size_t i = 0; i < header.count; ++i) {
+    vector[i].ResizeDefaultInit(offsets[i + 1] - offsets[i]);
+    AddSegments(iovecs, vector[i]);
+  }
+  iovecs.ReadAll(fd);
+  return vector;
+}
+
+// Read-only window onto serialized elements that stay where they were loaded or mapped.
+template<typename ElemT>
+class SerializedView {
+ public:
+  SerializedView() = default;
+
+  SerializedView(const ElemT* data, const size_t size) : data_{data}, size_{size} {
+  }
+
+  [[nodiscard]] inline size_t Size() const {
+    return size_;
+  }
+
+  [[nodiscard]] inline const ElemT* Data() const {
+    return data_;
+  }
+
+  inline const ElemT& operator[](const size_t index) const {
+    return data_[index];
+  }
+
+  inline const ElemT* begin() const {
+    return data_;
+  }
+
+  inline const ElemT* end() const {
+    return data_ + size_;
+  }
+
+ private:
+  const ElemT* data_{nullptr};
+  size_t size_{0};
+
+};
+
+template<typename ElemT>
+class NestedSerializedView {
+ public:
+  NestedSerializedView(const uint64_t* offsets, const ElemT* values, const size_t size) :
+    offsets_{offsets}, values_{values}, size_{size} {
+  }
+
+  [[nodiscard]] inline size_t Size() const {
+    return size_;
+  }
+
+  [[nodiscard]] inline SerializedView<ElemT> Values() const {
+    return SerializedView<ElemT>(values_, offsets_[size_]);
+  }
+
+  inline SerializedView<ElemT> operator[](const size_t index) const {
+    return SerializedView<ElemT>(values_ + offsets_[index], offsets_[index + 1] - offsets_[index]);
+  }
+
+ private:
+  const uint64_t* offsets_;
+  const ElemT* values_;
+  size_t size_;
+
+};
+
+inline SerializedHeader LoadSerializedHeader(const void* data) {
+  SerializedHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  return header;
+}
+
+template<typename ElemT>
+const ElemT* SerializedValues(const void* data, const SerializedLayout layout, const size_t count) {
+  const auto* values = static_cast<const unsigned char*>(data) + SerializedValuesOffset<ElemT>(layout, count);
+  if (reinterpret_cast<uintptr_t>(values) % alignof(ElemT) != 0 ||
+      reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0) {
+    throw std::invalid_argument(BAD_SERIALIZED_ALIGN_MSG);
+  }
+  return reinterpret_cast<const ElemT*>(values);
+}
+
+// data must hold a whole serialized vector of this type, as written by WriteTo.
+template<FlatSerializable VectorT>
+[[nodiscard]] SerializedView<typename VectorT::value_type> View(const void* data) {
+  using ElemT = typename VectorT::value_type;
+  const SerializedHeader header = LoadSerializedHeader(data);
+  CheckSerializedHeader<ElemT>(header, SerializedLayout::Flat);
+  return SerializedView<ElemT>(SerializedValues<ElemT>(data, SerializedLayout::Flat, header.count), header.count);
+}
+
+template<NestedSerializable VectorT>
+[[nodiscard]] NestedSerializedView<typename VectorT::value_type::value_type> View(const void* data) {
+  using ElemT = typename VectorT::value_type::value_type;
+  const SerializedHeader header = LoadSerializedHeader(data);
+  CheckSerializedHeader<ElemT>(header, SerializedLayout::Nested);
+  const ElemT* values = SerializedValues<ElemT>(data, SerializedLayout::Nested, header.count);
+  const auto* offsets = reinterpret_cast<const uint64_t*>(static_cast<const unsigned char*>(data) +
+                                                          SerializedHeader::BYTES);
+  return NestedSerializedView<ElemT>(offsets, values, header.count);
+}
+
+#endif /* vector_serialization.hpp */
@@ -1,8 +1,24 @@
 #include "vector.hpp"
+#include "segmented_algorithms.hpp"
+#include "compressed_bit_storage.hpp"
+#include "numeric_algorithms.hpp"
+#include "parallel_algorithms.hpp"
+#include "radix_sort.hpp"
+#include "concurrent_chunked_vector.hpp"
+#include "mmap_storage.hpp"
+#include "shared_memory_storage.hpp"
+#include "vector_serialization.hpp"
+#include "soa_vector.hpp"
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <ctime>
 #include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <string>
+#include <unistd.h>
 
 struct Point {
   Point() {}
@@ -12,6 +28,11 @@ struct Point {
   int y_ = 0;
 };
 
+template<>
+struct SoaLayout<Point> {
+  static constexpr auto MEMBERS = std::make_tuple(&Point::x_, &Point::y_);
+};
+
 void BoolTest() {
   Vector<bool> arr(10);
 
@@ -108,6 +129,99 @@ void TestChunkedStorage() {
   }
 }
 
+void TestChunkPool() {
+  using Storage = ChunkedStorage<int>;
+
+  Storage::Pool pool(16);
+  ResourceScope<Storage::Pool> scope(pool);
+
+  Vector<int, ChunkedStorage> filled(1000, 7);
+  for (size_t round = 0; round < 10; ++round) {
+    Vector<int, ChunkedStorage> buffer;
+    for (size_t i = 0; i < 5000; ++i) {
+      buffer.PushBack(static_cast<int>(i));
+    }
+    buffer.Resize(10);
+    buffer.Shrink();
+    buffer.Resize(3000);
+
+    Vector<int, ChunkedStorage> copy = buffer;
+    filled.PushBack(copy[9] + copy[2999]);
+  }
+
+  printf("%d %d hit rate: %.2f\n", filled[999], filled.Back(), pool.Stats().HitRate());
+}
+
+void TestSegments() {
+  Vector<int, ChunkedStorage> chunked(1000);
+  Fill(chunked, 1);
+
+  int counter = 0;
+  ForEach(chunked, [&counter](int& x) {
+    x += counter++;
+  });
+
+  std::vector<int> copied(chunked.Size());
+  Copy(chunked, copied.begin());
+
+  Vector<int> dynamic = {4, 8, 15, 16, 23, 42};
+  printf("%zu %zu %d %zu\n", Find(chunked, 700), Find(chunked, -1), copied[999], Find(dynamic, 23));
+}
+
+void TestSmallStorage() {
+  Vector<int, SmallStorage, 4> small = {1, 2, 3};
+  Vector<int, SmallStorage, 4> big = {1, 2, 3, 4, 5, 6, 7, 8};
+
+  std::swap(small, big);
+  printf("%zu %zu\n", small.Size(), big.Size());
+
+  small.Resize(2);
+  small.Shrink();
+  big = small;
+
+  Vector<Vector<int>, SmallStorage, 2> nested;
+  for (size_t i = 0; i < 5; ++i) {
+    nested.PushBack(Vector<int>(i));
+  }
+  Vector<Vector<int>, SmallStorage, 2> moved(std::move(nested));
+  moved.Resize(1);
+  moved.Shrink();
+
+  for (size_t i = 0; i < big.Size(); ++i) {
+    std::cout << big[i] << ' ';
+  }
+  std::cout << moved.Size() << '\n';
+}
+
+void TestAllocators() {
+  MonotonicArena arena;
+  {
+    ResourceScope<MonotonicArena> scope(arena);
+
+    Vector<Vector<int, ArenaStorage>, ArenaStorage> batch;
+    for (size_t i = 0; i < 100; ++i) {
+      batch.PushBack(Vector<int, ArenaStorage>());
+      for (size_t j = 0; j < i; ++j) {
+        batch.Back().PushBack(static_cast<int>(j));
+      }
+    }
+    printf("%zu %d\n", batch.Size(), batch[99][98]);
+  }
+  printf("arena blocks: %zu\n", arena.BlocksCnt());
+  arena.Release();
+
+  SizeClassPool pool;
+  ResourceScope<SizeClassPool> scope(pool);
+
+  Vector<Vector<int, PoolStorage>, PoolStorage> matrix;
+  for (size_t i = 0; i < 100; ++i) {
+    matrix.PushBack(Vector<int, PoolStorage>(i, 1));
+    matrix.Back().Shrink();
+  }
+  Vector<Vector<int, PoolStorage>, PoolStorage> copy = matrix;
+  printf("%zu %zu\n", copy.Size(), copy[50].Size());
+}
+
 void TestIterators() {
   Vector<int> v_arr = {1, 2, 3, 4, 5};
   auto v_it = v_arr.begin();
@@ -126,6 +240,133 @@ void TestIterators() {
 
 }
 
+void TestContiguousIterators() {
+  static_assert(std::contiguous_iterator<Vector<int>::iterator>);
+  static_assert(std::contiguous_iterator<Vector<int, SmallStorage, 8>::const_iterator>);
+  static_assert(!Vector<int, ChunkedStorage>::IS_CONTIGUOUS);
+  static_assert(sizeof(Vector<int, DynamicStorage, 0, NeverCheck>::iterator) == sizeof(int*));
+
+  Vector<int, DynamicStorage, 0, NeverCheck> unchecked = {5, 3, 1, 4, 2};
+  std::sort(unchecked.begin(), unchecked.end());
+  printf("%d %d\n", unchecked.Data()[0], *unchecked.rbegin());
+
+  Vector<int> checked = {1, 2, 3};
+  try {
+    auto it = checked.end();
+    std::cout << *it << '\n';
+  } catch (std::out_of_range& e) {
+    std::cout << "Out of range: " << e.what() << '\n';
+  }
+}
+
+template<typename VectorT>
+void TestBulkOps(const char* name) {
+  const int values[] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+  VectorT vector;
+  vector.Reserve(16);
+  vector.Append(values, values + 4);
+  vector.Insert(vector.cbegin() + 2, values + 4, values + 8);
+  vector.Erase(vector.cbegin(), vector.cbegin() + 1);
+
+  std::cout << name << ':';
+  for (const auto& x : vector) {
+    std::cout << ' ' << x;
+  }
+
+  vector.AssignN(3, 9);
+  std::cout << " | " << vector.Size() << ' ' << vector.Back() << '\n';
+}
+
+template<typename VectorT>
+size_t FillUninitialized(const size_t size) {
+  VectorT vector = {1};
+  vector.ResizeUninitialized(size);
+  for (size_t i = 1; i < size; ++i) {
+    vector.At(i) = static_cast<int>(i);
+  }
+  vector.ResizeDefaultInit(size / 2);
+  return vector.At(size / 2 - 1);
+}
+
+void TestUninitialized() {
+  Vector<int, MallocStorage> zeros(1 << 20);
+  long long sum = 0;
+  for (int x : zeros) {
+    sum += x;
+  }
+
+  Vector<Point> points = {Point(1, 2)};
+  points.ResizeDefaultInit(3);
+
+  printf("%lld %d %zu %zu %zu %zu\n", sum, points[2].x_,
+         FillUninitialized<Vector<int>>(1000),
+         FillUninitialized<Vector<int, StaticStorage, 1000>>(1000),
+         FillUninitialized<Vector<int, SmallStorage, 16>>(1000),
+         FillUninitialized<Vector<int, ChunkedStorage>>(1000));
+}
+
+struct MoveCounted {
+  MoveCounted(const int value) : value_{value} {}
+  MoveCounted(const MoveCounted& other_copy) = default;
+  MoveCounted(MoveCounted&& other_move) noexcept : value_{other_move.value_} {
+    ++moves;
+  }
+
+  static inline size_t moves = 0;
+
+  int value_ = 0;
+};
+
+template<>
+struct IsTriviallyRelocatable<MoveCounted> : std::true_type {
+};
+
+struct CountingAllocatorCopies {
+  static inline size_t copies = 0;
+};
+
+// Stateless like std::allocator, and like it not trivially copyable.
+template<typename ElemT>
+struct CountingAllocator : std::allocator<ElemT> {
+  CountingAllocator() = default;
+  CountingAllocator(const CountingAllocator& other_copy) noexcept : std::allocator<ElemT>(other_copy) {
+    ++CountingAllocatorCopies::copies;
+  }
+  CountingAllocator& operator=(const CountingAllocator&) noexcept {
+    ++CountingAllocatorCopies::copies;
+    return *this;
+  }
+};
+
+template<typename ElemT, size_t N>
+using CountingAllocatorStorage = DynamicStorage<ElemT, N, CountingAllocator>;
+
+static_assert(IS_TRIVIALLY_RELOCATABLE<Vector<int>>);
+static_assert(IS_TRIVIALLY_RELOCATABLE<Vector<int, CountingAllocatorStorage>>);
+static_assert(IS_TRIVIALLY_RELOCATABLE<Vector<int, MallocStorage>>);
+static_assert(IS_TRIVIALLY_RELOCATABLE<Vector<Vector<int>>>);
+static_assert(IS_TRIVIALLY_RELOCATABLE<Vector<int, ChunkedStorage>>);
+static_assert(!IS_TRIVIALLY_RELOCATABLE<Vector<std::string, ChunkedStorage>>);
+
+void TestRelocation() {
+  Vector<MoveCounted> counted;
+  for (int i = 0; i < 1000; ++i) {
+    counted.EmplaceBack(i);
+  }
+  assert(MoveCounted::moves == 0 && counted[999].value_ == 999);
+
+  // Moving a Vector copies its allocator, so growing the outer vector would copy one per
+  // inner vector if it moved them instead of relocating them.
+  Vector<Vector<int, CountingAllocatorStorage>> nested;
+  CountingAllocatorCopies::copies = 0;
+  for (int i = 0; i < 100; ++i) {
+    nested.EmplaceBack();
+    nested[i].PushBack(i);
+  }
+  assert(CountingAllocatorCopies::copies == 0 && nested[99][0] == 99);
+}
+
 void TestRange() {
   Vector<int> vec = {1, 2, 3, 4, 5};
 
@@ -167,17 +408,732 @@ void TestBoolIterators() {
   std::cout << '\n';
 }
 
+void TestBitQueries() {
+  Vector<bool> vec(200, false);
+  vec[3] = true;
+  vec[64] = true;
+  vec[150] = true;
+  vec[199] = true;
+
+  assert(vec.Count() == 4);
+  assert(vec.Any() && !vec.None() && !vec.All());
+  assert(vec.FindFirst(true) == 3);
+  assert(vec.FindNext(true, 3) == 64);
+  assert(vec.FindNext(true, 150) == 199);
+  assert(vec.FindNext(true, 199) == vec.Size());
+  assert(vec.FindFirst(false) == 0);
+
+  size_t expected[] = {3, 64, 150, 199};
+  size_t i = 0;
+  for (size_t index : vec.SetBits()) {
+    assert(index == expected[i++]);
+  }
+  assert(i == 4);
+
+  vec.Sort();
+  assert(vec.FindFirst(true) == 196 && vec.Count() == 4);
+
+  Vector<bool> ones(130, true);
+  assert(ones.All() && ones.Count() == 130);
+  ones.Resize(70);
+  ones.Resize(130);
+  assert(ones.Count() == 70 && ones.FindFirst(false) == 70);
+  ones.PopBack();
+  assert(ones.Size() == 129);
+}
+
+template<typename BoolVector>
+void TestBitOps() {
+  const size_t size = 20000;
+  BoolVector lhs(size);
+  BoolVector rhs(size);
+  for (size_t i = 0; i < size; ++i) {
+    lhs[i] = rand() % 2;
+    rhs[i] = rand() % 3 == 0;
+  }
+
+  BoolVector and_res = lhs & rhs;
+  BoolVector or_res = lhs | rhs;
+  BoolVector xor_res = lhs ^ rhs;
+  BoolVector and_not_res = AndNot(lhs, rhs);
+  BoolVector not_res = ~lhs;
+  BoolVector left = lhs << 67;
+  BoolVector right = lhs >> 130;
+  for (size_t i = 0; i < size; ++i) {
+    assert(and_res[i] == (lhs[i] && rhs[i]));
+    assert(or_res[i] == (lhs[i] || rhs[i]));
+    assert(xor_res[i] == (lhs[i] != rhs[i]));
+    assert(and_not_res[i] == (lhs[i] && !rhs[i]));
+    assert(not_res[i] == !lhs[i]);
+    assert(left[i] == (i >= 67 && lhs[i - 67]));
+    assert(right[i] == (i + 130 < size && lhs[i + 130]));
+  }
+  assert(not_res.Count() + lhs.Count() == size);
+
+  BoolVector range(size);
+  range.SetRange(10, 9000).ClearRange(100, 130);
+  assert(range.Count() == 8990 - 30);
+  assert(range.FindFirst(true) == 10 && range.FindNext(true, 99) == 130);
+  assert(range.FindNext(false, 10) == 100 && range.FindNext(false, 130) == 9000);
+}
+
+template<typename BoolVector>
+void TestRankSelect() {
+  const size_t size = 30000;
+  BoolVector bits(size);
+  for (size_t i = 0; i < size; ++i) {
+    bits[i] = rand() % 5 == 0;
+  }
+
+  const BoolVector& const_bits = bits;
+  size_t rank = 0;
+  for (size_t i = 0; i < size; ++i) {
+    assert(const_bits.Rank1(i) == rank);
+    if (const_bits[i]) {
+      assert(const_bits.Select1(rank) == i);
+      ++rank;
+    }
+  }
+  assert(bits.Rank1(size) == rank && bits.Select1(rank) == size);
+
+  bits.SetRange(0, 100);
+  assert(bits.Rank1(100) == 100 && bits.Rank0(100) == 0 && bits.Select1(99) == 99);
+
+  const BoolVector copy = bits;
+  assert(copy.Rank1(size) == bits.Count());
+
+  // A proxy taken before the index was built still has to invalidate it.
+  auto proxy = bits[0];
+  const size_t before = const_bits.Rank1(size);
+  proxy = !proxy;
+  assert(const_bits.Rank1(size) == bits.Count() && bits.Count() != before);
+}
+
+void TestCompressedBits() {
+  using CompressedBits = Vector<bool, CompressedBitStorage>;
+
+  const size_t size = 300000;
+  Vector<bool> dense(size);
+  Vector<bool> other_dense(size);
+  CompressedBits bits(size);
+  CompressedBits other(size);
+  for (size_t i = 0; i < 3000; ++i) {
+    const size_t index = rand() % size;
+    dense[index] = true;
+    bits[index] = true;
+  }
+  dense.SetRange(70000, 140000);
+  bits.SetRange(70000, 140000);
+  for (size_t i = 0; i < size; i += 3) {
+    other_dense[i] = true;
+    other[i] = true;
+  }
+  other_dense.ClearRange(200000, size);
+  other.ClearRange(200000, size);
+
+  assert(bits.Count() == dense.Count() && other.Count() == other_dense.Count());
+  assert(bits.FindFirst(true) == dense.FindFirst(true));
+  assert(bits.FindNext(false, 70000) == dense.FindNext(false, 70000));
+  assert(bits.FindNext(true, 69999) == dense.FindNext(true, 69999));
+  assert(CompressedBits(dense).Count() == dense.Count());
+
+  CompressedBits and_res = bits & other;
+  CompressedBits or_res = bits | other;
+  CompressedBits xor_res = bits ^ other_dense;
+  CompressedBits and_not_res = AndNot(bits, other_dense);
+  CompressedBits and_dense_res = bits & other_dense;
+  for (size_t i = 0; i < size; ++i) {
+    const bool lhs = dense[i];
+    const bool rhs = other_dense[i];
+    assert(static_cast<const CompressedBits&>(bits)[i] == lhs);
+    assert(and_res.Test(i) == (lhs && rhs) && and_dense_res.Test(i) == (lhs && rhs));
+    assert(or_res.Test(i) == (lhs || rhs));
+    assert(xor_res.Test(i) == (lhs != rhs));
+    assert(and_not_res.Test(i) == (lhs && !rhs));
+  }
+
+  size_t set_cnt = 0;
+  bits.ForEachSetBit([&](const size_t index) {
+    assert(dense[index]);
+    ++set_cnt;
+  });
+  assert(set_cnt == dense.Count());
+
+  bits.Shrink();
+  assert(bits.Count() == dense.Count());
+  assert(bits.BytesUsed() < size / 8);
+
+  // The container buffer keeps its capacity until Shrink, and BytesUsed counts it.
+  const size_t containers_cnt = bits.ContainersCnt();
+  bits.Resize(100);
+  bits.PopBack();
+  assert(bits.Size() == 99 && bits.ContainersCnt() <= 1);
+  assert(bits.BytesUsed() >= sizeof(bits) + containers_cnt * sizeof(RoaringContainer));
+}
+
+template<typename VectorT, typename OtherVectorT>
+void TestNumeric() {
+  using ElemT = typename VectorT::value_type;
+
+  const size_t size = 5000;
+  VectorT vector(size);
+  OtherVectorT other(size);
+  for (size_t i = 0; i < size; ++i) {
+    vector[i] = static_cast<ElemT>(i % 100);
+    other[i] = static_cast<ElemT>(2);
+  }
+  vector[1234] = static_cast<ElemT>(-7);
+  vector[4321] = static_cast<ElemT>(500);
+
+  const ElemT expected_sum = static_cast<ElemT>(50 * 99 * 49 + 50 * 99 - 34 - 7 + 500 - 21);
+  assert(Sum(vector) == expected_sum);
+  assert(Min(vector) == static_cast<ElemT>(-7) && Max(vector) == static_cast<ElemT>(500));
+  assert(Dot(vector, other) == 2 * expected_sum);
+
+  Axpy(vector, static_cast<ElemT>(3), other);
+  Mul(vector, other);
+  Add(vector, other);
+  Scale(vector, static_cast<ElemT>(2));
+  assert(vector[10] == static_cast<ElemT>(((10 + 6) * 2 + 2) * 2));
+  assert(Sum(vector) == static_cast<ElemT>(4 * expected_sum + 28 * size));
+
+  Fill(vector, 3);
+  assert(Sum(vector) == static_cast<ElemT>(3 * size));
+}
+
+template<typename VectorT>
+void TestSearch() {
+  using ElemT = typename VectorT::value_type;
+
+  const size_t size = 10000;
+  VectorT vector(size);
+  std::vector<ElemT> expected;
+  for (size_t i = 0; i < size; ++i) {
+    vector[i] = static_cast<ElemT>(i % 97);
+    if (i % 97 >= 10) {
+      expected.push_back(vector[i]);
+    }
+  }
+
+  assert(Find(vector, 96) == 96 && Find(vector, 200) == size);
+  assert(FindIf(vector, Greater(95)) == 96 && FindIf(vector, Less(0)) == size);
+  assert(Count(vector, 5) == (size + 96) / 97);
+  assert(CountIf(vector, GreaterEqual(10)) == expected.size());
+  assert(CountIf(vector, [](ElemT elem) { return elem >= 10; }) == expected.size());
+
+  VectorT copy = vector;
+  const size_t erased = EraseIf(vector, Less(10));
+  assert(erased == size - expected.size() && vector.Size() == expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    assert(vector[i] == expected[i]);
+  }
+
+  VectorT scalar_copy = copy;
+  assert(Compact(scalar_copy, [](ElemT elem) { return elem >= 10; }) == expected.size());
+  assert(Find(scalar_copy, 0) == scalar_copy.Size());
+
+  const size_t split = Partition(copy, NotEqual(3));
+  assert(split == size - Count(copy, 3) && copy.Size() == size);
+  assert(Find(copy, 3) == split && CountIf(copy, Equal(3)) == size - split);
+  assert(copy[0] == 0 && copy[3] == 4);
+}
+
+void TestSearchValueRange() {
+  Vector<uint8_t> bytes{44, 200};
+  assert(Count(bytes, 300) == 0 && Find(bytes, 256 + 44) == 2 && Count(bytes, 44) == 1);
+  assert(CountIf(bytes, Less(256)) == 2 && CountIf(bytes, Greater(-1)) == 2);
+  assert(CountIf(bytes, GreaterEqual(256)) == 0 && CountIf(bytes, NotEqual(-56)) == 2);
+  assert(CountIf(bytes, Less(44.5)) == 1 && FindIf(bytes, Greater(199.5)) == 1);
+
+  Vector<int> ints{2, -1, 3};
+  assert(CountIf(ints, Equal(2.5)) == 0 && CountIf(ints, NotEqual(2.5)) == 3);
+  assert(CountIf(ints, Less(2.5)) == 2 && CountIf(ints, Less(3e10)) == 3);
+  assert(CountIf(ints, Less(0u)) == 1 && Count(ints, 4294967295u) == 0);
+  assert(Compact(ints, GreaterEqual(-0.5)) == 2 && ints[1] == 3);
+
+  Vector<float> floats{0.1f, std::numeric_limits<float>::quiet_NaN(), 1e30f};
+  assert(Count(floats, 0.1) == 0 && CountIf(floats, NotEqual(0.1)) == 3);
+  assert(CountIf(floats, Less(1e300)) == 2 && EraseIf(floats, Greater(-1e300)) == 2);
+}
+
+struct CopyCounted {
+  CopyCounted() = default;
+  CopyCounted(const int value) : value_{value} {}
+  CopyCounted(const CopyCounted& other_copy) : value_{other_copy.value_} {
+    ++copies;
+  }
+  CopyCounted(CopyCounted&&) = default;
+  CopyCounted& operator=(const CopyCounted& other_copy) {
+    value_ = other_copy.value_;
+    ++copies;
+    return *this;
+  }
+  CopyCounted& operator=(CopyCounted&&) = default;
+
+  static inline size_t copies = 0;
+
+  int value_ = 0;
+};
+
+void TestPartitionMoves() {
+  Vector<CopyCounted, ChunkedStorage> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.EmplaceBack(i);
+  }
+  CopyCounted::copies = 0;
+  const size_t split = Partition(values, [](const CopyCounted& value) { return value.value_ % 3 == 0; });
+  assert(split == 334 && values.Size() == 1000 && CopyCounted::copies == 0);
+  assert(values[1].value_ == 3 && values[split].value_ == 1 && values[999].value_ == 998);
+}
+
+template<typename VectorT>
+void TestParallel(ThreadPool& pool) {
+  const size_t size = 100000;
+  VectorT vector(size);
+  for (size_t i = 0; i < size; ++i) {
+    vector[i] = rand() % 1000;
+  }
+
+  std::vector<int> expected(vector.begin(), vector.end());
+  std::sort(expected.begin(), expected.end());
+  const long long expected_sum = std::accumulate(expected.begin(), expected.end(), 0LL);
+
+  assert(ParallelReduce(vector, 0LL, std::plus<>{}, pool) == expected_sum);
+  ParallelForEach(vector, [](int& elem) { elem += 1; }, pool);
+  assert(ParallelReduce(vector, 0LL, std::plus<>{}, pool) == expected_sum + static_cast<long long>(size));
+
+  Vector<long long, ChunkedStorage> doubled(size);
+  ParallelTransform(vector, doubled, [](const int elem) { return 2LL * elem; }, pool);
+  assert(ParallelReduce(doubled, 0LL, std::plus<>{}, pool) == 2 * (expected_sum + static_cast<long long>(size)));
+
+  ParallelSort(vector, std::greater<>{}, pool);
+  for (size_t i = 0; i < size; ++i) {
+    assert(vector[i] == expected[size - 1 - i] + 1);
+  }
+}
+
+void TestThreadPool() {
+  ThreadPool pool(4);
+  std::atomic<size_t> calls{0};
+  pool.Run(64, [&](size_t) {
+    pool.Run(8, [&](size_t) { ++calls; });
+  });
+  assert(calls == 64 * 8);
+
+  bool thrown = false;
+  try {
+    pool.Run(16, [](const size_t task) {
+      if (task == 7) {
+        throw std::runtime_error("task failed");
+      }
+    });
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  TestParallel<Vector<int>>(pool);
+  TestParallel<Vector<int, ChunkedStorage>>(pool);
+  ThreadPool single(1);
+  TestParallel<Vector<int, PowerOfTwoChunkedStorage>>(single);
+}
+
+template<typename ElemT>
+ElemT RandomRadixValue() {
+  if constexpr (std::is_floating_point_v<ElemT>) {
+    return static_cast<ElemT>(rand() - RAND_MAX / 2) / 1000;
+  } else {
+    return static_cast<ElemT>((static_cast<uint64_t>(rand()) << 33) ^ (static_cast<uint64_t>(rand()) << 11) ^ rand());
+  }
+}
+
+template<typename VectorT>
+void TestRadixSort(ThreadPool& pool) {
+  using ElemT = typename VectorT::value_type;
+
+  for (const size_t size : {size_t{0}, size_t{1}, size_t{100}, size_t{1000}, size_t{70000}}) {
+    VectorT vector(size);
+    for (size_t i = 0; i < size; ++i) {
+      vector[i] = RandomRadixValue<ElemT>();
+    }
+    std::vector<ElemT> expected(vector.begin(), vector.end());
+    std::sort(expected.begin(), expected.end());
+
+    for (size_t variant = 0; variant < 4; ++variant) {
+      VectorT copy = vector;
+      switch (variant) {
+        case 0: RadixSort(copy); break;
+        case 1: StableRadixSort(copy); break;
+        case 2: RadixSort(copy, pool); break;
+        default: StableRadixSort(copy, pool); break;
+      }
+      assert(std::equal(expected.begin(), expected.end(), copy.begin()));
+    }
+  }
+}
+
+void TestRadixSortPairs(ThreadPool& pool) {
+  using Pair = std::pair<int32_t, uint32_t>;
+
+  const size_t size = 50000;
+  Vector<Pair, ChunkedStorage> pairs(size);
+  for (size_t i = 0; i < size; ++i) {
+    pairs[i] = {rand() % 1000 - 500, static_cast<uint32_t>(i)};
+  }
+  Vector<Pair, ChunkedStorage> unstable = pairs;
+
+  StableRadixSort(pairs, pool);
+  RadixSort(unstable);
+  long long payload_sum = 0;
+  for (size_t i = 1; i < size; ++i) {
+    assert(pairs[i - 1].first < pairs[i].first ||
+           (pairs[i - 1].first == pairs[i].first && pairs[i - 1].second < pairs[i].second));
+    assert(unstable[i].first == pairs[i].first);
+    payload_sum += unstable[i].second;
+  }
+  assert(payload_sum + unstable[0].second == static_cast<long long>(size) * (size - 1) / 2);
+}
+
+void TestRadixSorts() {
+  ThreadPool pool(4);
+  TestRadixSort<Vector<int>>(pool);
+  TestRadixSort<Vector<uint64_t, ChunkedStorage>>(pool);
+  TestRadixSort<Vector<float, MallocStorage>>(pool);
+  TestRadixSort<Vector<double, PowerOfTwoChunkedStorage>>(pool);
+  TestRadixSort<Vector<int16_t, SmallStorage, 8>>(pool);
+  TestRadixSort<Vector<uint8_t>>(pool);
+  TestRadixSortPairs(pool);
+}
+
+void TestConcurrentChunkedVector() {
+  const size_t writers_cnt = 4;
+  const size_t per_writer = 20000;
+
+  ConcurrentChunkedVector<uint64_t, PowerOfTwoChunks<6>> vector;
+  vector.Reserve(1000);
+  std::atomic<bool> writing{true};
+  std::thread reader([&] {
+    while (writing.load()) {
+      const size_t size = vector.Size();
+      for (size_t i = size > 100 ? size - 100 : 0; i < size; ++i) {
+        assert(vector[i] != 0);
+      }
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (size_t writer = 0; writer < writers_cnt; ++writer) {
+    writers.emplace_back([&vector, writer] {
+      for (size_t i = 0; i < per_writer; ++i) {
+        if (i % 100 == 0) {
+          const size_t first = vector.GrowBy(3, writer << 32 | i | 1u << 31);
+          assert(vector[first + 2] == (writer << 32 | i | 1u << 31));
+        } else {
+          vector.PushBack(writer << 32 | (i + 1));
+        }
+      }
+    });
+  }
+  for (std::thread& writer : writers) {
+    writer.join();
+  }
+  writing = false;
+  reader.join();
+
+  const size_t grown = per_writer / 100;
+  assert(vector.Size() == writers_cnt * (per_writer + 2 * grown));
+  std::vector<size_t> last(writers_cnt, 0);
+  size_t pushed = 0;
+  vector.ForEachSegment([&](const uint64_t* data, const size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      if ((data[i] & (1u << 31)) == 0) {
+        const size_t writer = data[i] >> 32;
+        assert((data[i] & 0xffffffff) > last[writer]);
+        last[writer] = data[i] & 0xffffffff;
+        ++pushed;
+      }
+    }
+  });
+  assert(pushed == writers_cnt * (per_writer - grown));
+
+  ConcurrentChunkedVector<std::string> strings;
+  strings.EmplaceBack(3, 'a');
+  strings.PushBack("bc");
+  assert(strings.Size() == 2 && strings[0] == "aaa" && strings[1] == "bc");
+
+  ConcurrentChunkedVector<std::array<int32_t, 6>> triples;
+  for (size_t i = 0; i < 100; ++i) {
+    triples.GrowBy(i, {static_cast<int32_t>(i)});
+  }
+  assert(triples.Size() == 99 * 100 / 2 && triples[triples.Size() - 1][0] == 99 && triples[0][0] == 1);
+}
+
+void TestMmapStorage() {
+  struct Record {
+    int64_t key;
+    double value;
+  };
+
+  const std::string path = "/tmp/vector_mmap_test_" + std::to_string(getpid()) + ".bin";
+  unlink(path.c_str());
+  const size_t size = 100000;
+  {
+    Vector<Record, MmapStorage> records(IN_PLACE_STORAGE, path.c_str());
+    assert(records.GetStorage().IsFileBacked() && records.Size() == 0);
+    for (size_t i = 0; i < size; ++i) {
+      records.PushBack(Record{static_cast<int64_t>(i), i * 0.5});
+    }
+    records.GetStorage().Sync();
+  }
+  {
+    Vector<Record, MmapStorage> records(IN_PLACE_STORAGE, path.c_str(), MmapAdvice::Sequential);
+    assert(records.Size() == size && records[size - 1].key == size - 1 && records[7].value == 3.5);
+    records.Resize(10);
+    records.Shrink();
+    assert(records.GetStorage().Capacity() < size);
+    records.Resize(20);
+    assert(records[9].key == 9 && records[19].key == 0);
+  }
+
+  bool rejected = false;
+  try {
+    Vector<int32_t, MmapStorage> wrong_type(IN_PLACE_STORAGE, path.c_str());
+  } catch (const std::runtime_error&) {
+    rejected = true;
+  }
+  assert(rejected);
+  unlink(path.c_str());
+
+  Vector<int, MmapStorage> anonymous(1000, 3);
+  assert(!anonymous.GetStorage().IsFileBacked());
+  const std::vector<int> more(1000, 3);
+  anonymous.Append(more.begin(), more.end());
+  assert(anonymous.Size() == 2000 && std::count(anonymous.begin(), anonymous.end(), 3) == 2000);
+  Vector<int, MmapStorage> moved(std::move(anonymous));
+  moved.PushBack(4);
+  anonymous.PushBack(5);
+  assert(moved.Size() == 2001 && anonymous.Size() == 1 && anonymous[0] == 5);
+
+  // Advice is a hint, and DontNeed must not drop the contents of anonymous storage.
+  Vector<int, MmapStorage> advised(10, 7);
+  advised.GetStorage().Advise(MmapAdvice::DontNeed);
+  assert(advised.Size() == 10 && advised[9] == 7);
+  advised.Resize(100000);
+  advised.GetStorage().Advise(MmapAdvice::DontNeed);
+  assert(advised.Size() == 100000 && advised[0] == 7 && advised[99999] == 0);
+}
+
+void TestSharedMemoryStorage() {
+  struct Node {
+    int value;
+    OffsetPtr<Node> next;
+  };
+
+  const std::string name = "/vector_shm_test_" + std::to_string(getpid());
+  SharedMemoryStorage<Node>::Unlink(name.c_str());
+  Vector<Node, SharedMemoryStorage> writer(IN_PLACE_STORAGE, name.c_str(), SharedMode::Create);
+  Vector<Node, SharedMemoryStorage> reader(IN_PLACE_STORAGE, name.c_str(), SharedMode::Attach);
+  SharedMemoryStorage<Node>::Unlink(name.c_str());
+  assert(reader.Size() == 0 && !reader.GetStorage().IsWriter());
+
+  const size_t size = 10000;
+  for (size_t i = 0; i < size; ++i) {
+    writer.PushBack(Node{static_cast<int>(i), nullptr});
+  }
+  for (size_t i = 0; i + 1 < size; ++i) {
+    writer[i].next = &writer[i + 1];
+  }
+  assert(reader.Size() == 0);
+  writer.GetStorage().Publish();
+  reader.GetStorage().Refresh();
+  assert(reader.Size() == size && reader.Data() != writer.Data());
+
+  int sum = 0;
+  size_t visited = 0;
+  for (const Node* node = &reader[0]; node != nullptr; node = node->next.Get()) {
+    sum += node->value;
+    ++visited;
+  }
+  assert(visited == size && sum == static_cast<int>(size * (size - 1) / 2));
+
+  bool rejected = false;
+  try {
+    reader.PushBack(Node{0, nullptr});
+  } catch (const std::logic_error&) {
+    rejected = true;
+  }
+  assert(rejected && reader.Size() == size);
+
+  Vector<Point, SharedMemoryStorage> points(100, Point(1, 2));
+  Vector<Point, SharedMemoryStorage> attached(IN_PLACE_STORAGE, FileDescriptor(dup(points.GetStorage().File().Get())));
+  assert(attached.Size() == 100 && attached[99].y_ == 2);
+}
+
+void TestSerialization() {
+  const std::string path = "/tmp/vector_serialization_test_" + std::to_string(getpid()) + ".bin";
+  FileDescriptor file(open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600));
+  unlink(path.c_str());
+  assert(file.IsOpen());
+
+  Vector<int, ChunkedStorage> flat(100000);
+  std::iota(flat.begin(), flat.end(), -50000);
+  Vector<Vector<double>> nested;
+  for (size_t i = 0; i < 300; ++i) {
+    nested.PushBack(Vector<double>(i % 7, i * 0.25));
+  }
+  WriteTo(file.Get(), flat);
+  WriteTo(file.Get(), nested);
+  const size_t bytes = SerializedBytes(flat) + SerializedBytes(nested);
+  assert(file.FileBytes() == bytes);
+
+  lseek(file.Get(), 0, SEEK_SET);
+  const Vector<int> flat_read = ReadFrom<Vector<int>>(file.Get());
+  const Vector<Vector<double>, ChunkedStorage> nested_read = ReadFrom<Vector<Vector<double>, ChunkedStorage>>(file.Get());
+  assert(flat_read.Size() == flat.Size() && std::equal(flat.begin(), flat.end(), flat_read.begin()));
+  assert(nested_read.Size() == nested.Size() && nested_read[299].Size() == 299 % 7 && nested_read[299][0] == 299 * 0.25);
+
+  Vector<uint64_t> buffer(bytes / sizeof(uint64_t) + 1);
+  lseek(file.Get(), 0, SEEK_SET);
+  assert(read(file.Get(), buffer.Data(), bytes) == static_cast<ssize_t>(bytes));
+  const auto flat_view = View<Vector<int>>(buffer.Data());
+  assert(flat_view.Size() == flat.Size() && flat_view[0] == -50000 && flat_view[99999] == 49999);
+  const auto nested_view = View<Vector<Vector<double>>>(reinterpret_cast<const char*>(buffer.Data()) + SerializedBytes(flat));
+  assert(nested_view.Size() == 300 && nested_view[13].Size() == 6 && nested_view[13][5] == 13 * 0.25);
+  assert(nested_view.Values().Size() == std::accumulate(nested.begin(), nested.end(), size_t{0},
+    [](const size_t sum, const Vector<double>& inner) { return sum + inner.Size(); }));
+
+  bool rejected = false;
+  try {
+    (void)View<Vector<float>>(buffer.Data());
+  } catch (const std::runtime_error&) {
+    rejected = true;
+  }
+  assert(rejected);
+}
+
+void TestAlignedStorages() {
+  Vector<double, AlignedStorage> aligned(3, 1.5);
+  for (size_t i = 0; i < 1000; ++i) {
+    aligned.PushBack(i);
+    assert(reinterpret_cast<uintptr_t>(aligned.Data()) % CACHE_LINE_SIZE == 0);
+  }
+  Vector<float, AlignedTo<256>::Storage> wide(10);
+  assert(reinterpret_cast<uintptr_t>(wide.Data()) % 256 == 0);
+
+  const size_t huge_size = 3 * HUGE_PAGE_SIZE / sizeof(double) + 5;
+  Vector<double, HugePageStorage> huge(huge_size);
+  assert(reinterpret_cast<uintptr_t>(huge.Data()) % HUGE_PAGE_SIZE == 0);
+  assert(std::count(huge.begin(), huge.end(), 0.0) == static_cast<ptrdiff_t>(huge_size));
+
+  Vector<double, HugePageStorage> growing;
+  for (size_t i = 0; i < huge_size; ++i) {
+    growing.PushBack(i);
+  }
+  assert(reinterpret_cast<uintptr_t>(growing.Data()) % HUGE_PAGE_SIZE == 0 && growing[huge_size - 1] == huge_size - 1);
+  Vector<double, HugePageStorage> copy = growing;
+  growing.Resize(10);
+  growing.Shrink();
+  assert(copy.Size() == huge_size && copy[12345] == 12345 && growing[9] == 9);
+}
+
+struct Checked {
+  Checked() = default;
+  Checked(const int value) : value_{value} {
+    if (value < 0) {
+      throw std::invalid_argument("negative");
+    }
+  }
+
+  int value_ = 0;
+};
+
+void TestSoaVector() {
+  SoaVector<Point> points;
+  for (int i = 0; i < 1000; ++i) {
+    points.PushBack(Point(i, -i));
+  }
+  points.EmplaceBack(7, 8);
+  assert(points.Size() == 1001 && points.Column<0>().Size() == 1001);
+  assert(Sum(points.Column<0>()) == 999 * 1000 / 2 + 7);
+
+  const Point last = points[1000];
+  assert(last.x_ == 7 && last.y_ == 8);
+  points[3] = Point(30, 40);
+  points[4] = points[3];
+  assert(points[4].Get<0>() == 30 && points.ColumnSpan<1>()[4] == 40);
+  for (auto row : points) {
+    row.Get<1>() = row.Get<0>();
+  }
+  const auto& const_points = points;
+  int mismatched = 0;
+  for (const Point point : const_points) {
+    mismatched += point.x_ != point.y_;
+  }
+  assert(mismatched == 0);
+
+  BasicSoaVector<std::tuple<double, Checked>, ChunkedStorage> rows(5);
+  rows.EmplaceBack(1.5, 2);
+  bool thrown = false;
+  try {
+    rows.EmplaceBack(2.5, -1);
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown && rows.Size() == 6 && rows.Column<0>().Size() == 6 && rows.Column<1>().Size() == 6);
+  const std::tuple<double, Checked> row = rows[5];
+  assert(std::get<0>(row) == 1.5 && std::get<1>(row).value_ == 2);
+  rows.PopBack();
+  assert(rows.Size() == 5 && rows[4].Get<0>() == 0.0);
+}
+
 int main() {
   srand(time(NULL));
 
   CommonTest();
   BoolTest();
   TestChunkedStorage();
+  TestChunkPool();
+  TestSegments();
+  TestSmallStorage();
+  TestAllocators();
+  TestAlignedStorages();
 
   TestIterators();
+  TestContiguousIterators();
   TestRange();
+  TestUninitialized();
+  TestRelocation();
+  TestBulkOps<Vector<int>>("dynamic");
+  TestBulkOps<Vector<int, StaticStorage, 16>>("static");
+  TestBulkOps<Vector<int, ChunkedStorage>>("chunked");
+  TestBulkOps<Vector<int, SmallStorage, 4>>("small");
 
   TestBoolIterators();
+  TestBitQueries();
+  TestBitOps<Vector<bool>>();
+  TestBitOps<Vector<bool, ChunkedStorage>>();
+  TestRankSelect<Vector<bool>>();
+  TestRankSelect<Vector<bool, ChunkedStorage>>();
+  TestCompressedBits();
+  TestNumeric<Vector<int>, Vector<int>>();
+  TestNumeric<Vector<float, ChunkedStorage>, Vector<float, ChunkedStorage>>();
+  TestNumeric<Vector<double, ChunkedStorage>, Vector<double>>();
+  TestNumeric<Vector<int64_t>, Vector<int64_t, ChunkedStorage>>();
+  TestNumeric<Vector<int16_t, SmallStorage, 4>, Vector<int16_t, SmallStorage, 4>>();
+  TestSearch<Vector<int32_t>>();
+  TestSearch<Vector<uint64_t, ChunkedStorage>>();
+  TestSearch<Vector<float>>();
+  TestSearch<Vector<int16_t, ChunkedStorage>>();
+  TestSearch<Vector<uint8_t>>();
+  TestSearchValueRange();
+  TestPartitionMoves();
+  TestThreadPool();
+  TestRadixSorts();
+  TestConcurrentChunkedVector();
+  TestMmapStorage();
+  TestSharedMemoryStorage();
+  TestSerialization();
+  TestSoaVector();
 
   return 0;
 }